@@ -0,0 +1,89 @@
+#ifndef PUZZLES_BINOM_CONST_H
+#define PUZZLES_BINOM_CONST_H
+
+// Binomial tables computed by the compiler (C++17): constexpr std::array
+// constants in .rodata, so a query is one load without any startup cost.
+//
+//     binom_ct(n, k)              C(n, k) for n < BINOM_CT_ROWS
+//     subset_rank_ct<N, K>(s)     rank of a K-subset of N elements
+//                                 in the order of Gosper's hack
+//
+// Both are constexpr as well, so they can be folded into constants.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+// Rows 0..BINOM_CT_ROWS-1: C(67, 33) is the last row maximum fitting uint64_t
+const int BINOM_CT_ROWS = 68;
+
+// Pascal triangle of N rows, flat: row n starts at n(n+1)/2
+template <int N>
+constexpr std::array<uint64_t, N * (N + 1) / 2> make_pascal_rows()
+{
+    std::array<uint64_t, N * (N + 1) / 2> t{};
+    for (int n = 0; n < N; n++) {
+        size_t row = (size_t)n * (n + 1) / 2, prev = row - n;
+        t[row] = t[row + n] = 1;
+        for (int k = 1; k < n; k++) {
+            t[row + k] = t[prev + k - 1] + t[prev + k];
+        }
+    }
+    return t;
+}
+
+template <int N>
+inline constexpr auto pascal_rows = make_pascal_rows<N>();
+
+// C(n, k) for 0 <= n < BINOM_CT_ROWS, 0 outside the triangle
+constexpr uint64_t binom_ct(int n, int k)
+{
+    return (k < 0 || k > n || n >= BINOM_CT_ROWS) ? 0
+        : pascal_rows<BINOM_CT_ROWS>[(size_t)n * (n + 1) / 2 + k];
+}
+
+// Combinatorial number system of K-subsets of N elements:
+// t[c][i] = C(c, i+1) is the share of element c when it is the (i+1)-th
+// smallest one, the rank is the sum of the shares of all elements
+template <int N, int K>
+constexpr std::array<std::array<uint64_t, K>, N> make_rank_table()
+{
+    static_assert(N <= 64,
+                  "the subsets are uint64_t masks: N shall not exceed 64");
+    std::array<std::array<uint64_t, K>, N> t{};
+    for (int c = 0; c < N; c++) {
+        for (int i = 0; i < K; i++) {
+            t[c][i] = binom_ct(c, i + 1);
+        }
+    }
+    return t;
+}
+
+template <int N, int K>
+inline constexpr auto rank_table = make_rank_table<N, K>();
+
+// Rank of subset s (K of the lowest N bits set) in the order of
+// Gosper's hack, one load per element
+template <int N, int K>
+constexpr uint64_t subset_rank_ct(uint64_t s)
+{
+    static_assert(N <= 64,
+                  "the subsets are uint64_t masks: N shall not exceed 64");
+    uint64_t r = 0;
+    int i = 0;
+    for (int c = 0; c < N && i < K; c++) {
+        if ((s >> c) & 1) {
+            r += rank_table<N, K>[c][i++];
+        }
+    }
+    return r;
+}
+
+// checked by the compiler
+static_assert(binom_ct(10, 3) == 120, "C(10, 3)");
+static_assert(binom_ct(67, 33) == 14226520737620288370ULL, "C(67, 33)");
+static_assert(binom_ct(5, 6) == 0 && binom_ct(0, 0) == 1, "edges");
+static_assert(subset_rank_ct<8, 3>(0x07) == 0, "first 3-subset");
+static_assert(subset_rank_ct<8, 3>(0xE0) == 55, "last 3-subset of 8");
+
+#endif // PUZZLES_BINOM_CONST_H
@@ -0,0 +1,131 @@
+#ifndef PUZZLES_BINOM_MOD_H
+#define PUZZLES_BINOM_MOD_H
+
+// C(n, k) mod p for a prime p:
+//
+//     binom_mod bm(1000000007, 1000000);   // tables up to n = 10^6
+//     uint32_t c = bm(n, k);
+//     bm.batch(ns, ks, out, count);
+//
+// n! and 1/n! mod p are tabulated up to min(maxn, p-1) in O(maxn),
+// so C(n, k) = n! / (k! (n-k)!) is two multiplications for n in the table.
+// Larger n are split into base p digits by Lucas' theorem:
+// C(n, k) = prod C(n_i, k_i) mod p, every digit binomial from the table
+// when p is small (p <= maxn + 1), otherwise multiplicatively in O(k_i).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+class binom_mod
+{
+public:
+    binom_mod(uint32_t p, uint32_t maxn)
+        : p_(p), size_(std::min<uint64_t>(maxn, p - 1) + 1),
+          fact_(size_), inv_fact_(size_)
+    {
+        fact_[0] = 1;
+        for (uint32_t i = 1; i < size_; i++) {
+            fact_[i] = mulm(fact_[i - 1], i);
+        }
+        inv_fact_[size_ - 1] = powm(fact_[size_ - 1], p_ - 2);
+        for (uint32_t i = size_ - 1; i > 0; i--) {
+            inv_fact_[i - 1] = mulm(inv_fact_[i], i);
+        }
+    }
+
+    uint32_t p() const { return p_; }
+
+    // C(n, k) mod p
+    uint32_t operator()(uint64_t n, uint64_t k) const
+    {
+        if (k > n) {
+            return 0;
+        }
+        if (n < size_) {
+            return table(n, k);
+        }
+        // Lucas: digit by digit in base p
+        uint32_t r = 1;
+        while (n && r) {
+            uint32_t ni = n % p_, ki = k % p_;
+            if (ki > ni) {
+                return 0;
+            }
+            r = mulm(r, small(ni, ki));
+            n /= p_;
+            k /= p_;
+        }
+        return r;
+    }
+
+    // out[i] = C(n[i], k[i]) mod p
+    void batch(const uint64_t* n, const uint64_t* k, uint32_t* out,
+               size_t count) const
+    {
+        size_t i = 0;
+        // the common case without the calls, the rest as above
+        for (; i < count; i++) {
+            if (k[i] <= n[i] && n[i] < size_) {
+                out[i] = table(n[i], k[i]);
+            } else {
+                out[i] = (*this)(n[i], k[i]);
+            }
+        }
+    }
+
+private:
+    uint32_t mulm(uint64_t a, uint64_t b) const
+    {
+        return (uint32_t)(a * b % p_);
+    }
+
+    uint32_t powm(uint64_t a, uint64_t e) const
+    {
+        uint64_t r = 1;
+        for (a %= p_; e; e >>= 1) {
+            if (e & 1) {
+                r = r * a % p_;
+            }
+            a = a * a % p_;
+        }
+        return (uint32_t)r;
+    }
+
+    // k <= n < size_
+    uint32_t table(uint64_t n, uint64_t k) const
+    {
+        return mulm(mulm(fact_[n], inv_fact_[k]), inv_fact_[n - k]);
+    }
+
+    // C(n, k) mod p for k <= n < p
+    uint32_t small(uint32_t n, uint32_t k) const
+    {
+        if (n < size_) {
+            return table(n, k);
+        }
+        k = std::min(k, n - k);
+        if (k >= size_) {
+            // n - k + 1 .. n over k!, k! not in the table
+            uint64_t num = 1, den = 1;
+            for (uint32_t i = 1; i <= k; i++) {
+                num = num * (n - k + i) % p_;
+                den = den * i % p_;
+            }
+            return mulm(num, powm(den, p_ - 2));
+        }
+        uint64_t num = 1;
+        for (uint32_t i = 1; i <= k; i++) {
+            num = num * (n - k + i) % p_;
+        }
+        return mulm(num, inv_fact_[k]);
+    }
+
+    uint32_t p_;
+    uint32_t size_;
+    std::vector<uint32_t> fact_;
+    std::vector<uint32_t> inv_fact_;
+};
+
+#endif // PUZZLES_BINOM_MOD_H
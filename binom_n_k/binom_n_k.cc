@@ -1,30 +1,39 @@
 #include <algorithm>
 #include <vector>
 #include <iostream>  // std::cin, std::cout
+#include <string>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h>  // atoi(), atoll(), calloc()
+#include <cmath>     // std::lgamma()
+
+#include "binom_mod.h"
+#include "binom_const.h"
 
 int binomialCoeff1(int n, int k)
 {
-    int C[n + 1][k + 1];
+    // C[i][j] is C[i * w + j], on the heap: a VLA of (n+1)*(k+1)
+    // overflows the stack for moderate n; the sizes and indices are size_t,
+    // in int they overflow before the allocation does
+    const size_t w = (size_t)k + 1;
+    std::vector<int> C(((size_t)n + 1) * w, 3);
     int i, j;
 
-    for (i = 0; i <= n; i++)
-        for (j = 0; j <= k; j++)
-            C[i][j] = 3;
-
     // Caculate value of Binomial Coefficient in bottom up manner
     for (i = 0; i <= n; i++) {
         for (j = 0; j <= std::min(i, k); j++) {
             if (j == 0 || j == i) {
                 // Base case
-                C[i][j] = 1;
+                C[i * w + j] = 1;
             } else {
                 // Calculate value using previosly stored values
-                C[i][j] = C[i - 1][j - 1] + C[i - 1][j];
+                C[i * w + j] = C[(i - 1) * w + j - 1]
+                               + C[(i - 1) * w + j];
             }
         }
     }
 
-    return C[n][k];
+    return C[n * w + k];
 }
 
 int binomialCoeff2(int n, int k)
@@ -54,16 +63,507 @@ int binomialCoeff3(int n, int k)
     return c;
 }
 
+// Pascal triangle shared by all queries, grown lazily up to the largest
+// n asked so far (n^2/2 entries: meant for n up to a few thousand).
+// The rows are stored one after another in a flat array (row n starts
+// at n(n+1)/2), every row is computed once from the previous one,
+// after that a query is O(1): one load.
+// The values wrap around modulo 2^64 beyond C(67, 33).
+class binom_table
+{
+public:
+    binom_table() : rows_(0) {}
+
+    uint64_t operator()(int n, int k)
+    {
+        if (k < 0 || k > n) {
+            return 0;
+        }
+        if (n >= rows_) {
+            grow(n + 1);
+        }
+        return t_[(size_t)n * (n + 1) / 2 + k];
+    }
+
+    // Computes the rows up to n - 1
+    void grow(int n)
+    {
+        if (n <= rows_) {
+            return;
+        }
+        // at least 1/4 more rows, so that growing row by row is amortized
+        // O(1) while the memory stays within ~1.6 times of what is needed;
+        // reserve() first, resize() alone would double the capacity
+        n = std::max(n, rows_ + rows_ / 4);
+        t_.reserve((size_t)n * (n + 1) / 2);
+        t_.resize((size_t)n * (n + 1) / 2);
+        for (int i = rows_; i < n; i++) {
+            uint64_t* row = &t_[(size_t)i * (i + 1) / 2];
+            const uint64_t* prev = row - i;
+            row[0] = row[i] = 1;
+            for (int j = 1; j < i; j++) {
+                row[j] = prev[j - 1] + prev[j];
+            }
+        }
+        rows_ = n;
+    }
+
+    int rows() const { return rows_; }
+
+private:
+    int rows_;
+    std::vector<uint64_t> t_;
+};
+
+// Exact binomial coefficients
+
+typedef unsigned __int128 uint128_t;
+
+inline uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// C(n, k) in 128 bits, false if it does not fit.
+// r = C(n-k+i, i) after step i, so r * (n-k+i) is divisible by i;
+// dividing r by gcd(r, i) first leaves i' = i / gcd coprime with r,
+// so i' divides n-k+i and nothing larger than the result is formed.
+// O(min(k, n-k)) steps.
+bool binom_u128(uint64_t n, uint64_t k, uint128_t& r)
+{
+    r = 0;
+    if (k > n) {
+        return true;
+    }
+    k = std::min(k, n - k);
+    r = 1;
+    for (uint64_t i = 1; i <= k; i++) {
+        uint64_t g = gcd((uint64_t)(r % i), i);
+        uint64_t t = (n - k + i) / (i / g);
+        r /= g;
+        if (r > ~(uint128_t)0 / t) {
+            return false;
+        }
+        r *= t;
+    }
+    return true;
+}
+
+// Unsigned big integer: 32-bit digits, the least significant first
+struct big_uint
+{
+    std::vector<uint32_t> d;
+
+    big_uint(uint128_t v = 0)
+    {
+        for (; v; v >>= 32) {
+            d.push_back((uint32_t)v);
+        }
+    }
+
+    // *this *= m, a multiplier of 64 bits is two digits
+    void mul(uint64_t m)
+    {
+        if (m >> 32) {
+            uint128_t carry = 0;
+            for (auto& x : d) {
+                carry += (uint128_t)x * m;
+                x = (uint32_t)carry;
+                carry >>= 32;
+            }
+            for (; carry; carry >>= 32) {
+                d.push_back((uint32_t)carry);
+            }
+            return;
+        }
+        uint64_t carry = 0;
+        for (auto& x : d) {
+            carry += (uint64_t)x * m;
+            x = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry) {
+            d.push_back((uint32_t)carry);
+        }
+    }
+
+    // *this /= m for m > 0, returns the remainder
+    uint64_t div(uint64_t m)
+    {
+        if (m >> 32) {
+            uint128_t rem = 0;
+            for (size_t i = d.size(); i-- > 0; ) {
+                uint128_t cur = (rem << 32) | d[i];
+                d[i] = (uint32_t)(cur / m);
+                rem = cur % m;
+            }
+            trim();
+            return (uint64_t)rem;
+        }
+        uint64_t rem = 0;
+        for (size_t i = d.size(); i-- > 0; ) {
+            uint64_t cur = (rem << 32) | d[i];
+            d[i] = (uint32_t)(cur / m);
+            rem = cur % m;
+        }
+        trim();
+        return rem;
+    }
+
+    // Drops the leading zero digits
+    void trim()
+    {
+        while (!d.empty() && !d.back()) {
+            d.pop_back();
+        }
+    }
+
+    size_t bits() const
+    {
+        return d.empty() ? 0 : 32 * d.size() - __builtin_clz(d.back());
+    }
+
+    // Decimal digits, by 9 at a time
+    std::string str() const
+    {
+        if (d.empty()) {
+            return "0";
+        }
+        big_uint q(*this);
+        std::vector<uint32_t> parts; // base 10^9, the least significant first
+        while (!q.d.empty()) {
+            parts.push_back((uint32_t)q.div(1000000000));
+        }
+        std::string s = std::to_string(parts.back());
+        for (size_t i = parts.size() - 1; i-- > 0; ) {
+            std::string p = std::to_string(parts[i]);
+            s += std::string(9 - p.size(), '0') + p;
+        }
+        return s;
+    }
+};
+
+// C(n, k) for k <= n - k multiplicatively: r = C(n-k+i, i) after step i,
+// so r * (n-k+i) / i is exact, and so is r * (n-k+i+1)...(n-k+j) / (i+1)...j,
+// a run of steps whose factors fit a 64-bit multiplier and a 32-bit
+// divisor (the division by 32 bits is the fast one).
+// O(k) passes over the result.
+big_uint binom_exact_mul(uint64_t n, uint64_t k)
+{
+    big_uint res(1);
+    for (uint64_t i = 1; i <= k; ) {
+        uint64_t num = n - k + i;
+        uint64_t den = i++;
+        while (i <= k && (n - k + i) <= UINT64_MAX / num &&
+               i <= 0xFFFFFFFFULL / den) {
+            num *= n - k + i;
+            den *= i++;
+        }
+        res.mul(num);
+        res.div(den);
+    }
+    return res;
+}
+
+// C(n, k) for k <= n - k as the product of the prime powers p^e, where
+// e = sum over p^j <= n of floor(n/p^j) - floor(k/p^j) - floor((n-k)/p^j)
+// (Legendre's formula), over the primes up to n from a sieve.
+// The factors are packed into 32-bit multipliers, so the cost is
+// O(n) for the sieve plus O(size of the result) per multiplier.
+big_uint binom_exact_sieve(uint64_t n, uint64_t k)
+{
+    std::vector<bool> composite(n + 1);
+    big_uint res(1);
+    uint64_t acc = 1;
+    for (uint64_t p = 2; p <= n; p++) {
+        if (composite[p]) {
+            continue;
+        }
+        for (uint64_t q = p * p; p <= n / p && q <= n; q += p) {
+            composite[q] = true;
+        }
+        unsigned e = 0;
+        for (uint64_t pj = p; pj <= n; pj *= p) {
+            e += n / pj - k / pj - (n - k) / pj;
+            if (pj > n / p) {
+                break;
+            }
+        }
+        for (; e > 0; e--) {
+            // a prime of 32 bits or more is a multiplier of its own
+            if (p > 0xFFFFFFFFULL / acc) {
+                res.mul(acc);
+                acc = 1;
+            }
+            acc *= p;
+        }
+    }
+    res.mul(acc);
+    return res;
+}
+
+// Exact C(n, k) of any size: binom_u128 if the result fits,
+// otherwise binom_exact_mul, or binom_exact_sieve when k is so large
+// that the sieve costs less than the k passes over the result.
+// With w digits of the result, the passes take ~ k*w, the sieve ~ 3n
+// plus w^2/3 for the multipliers (measured, 10^3 <= n <= 10^7).
+big_uint binom_exact(uint64_t n, uint64_t k)
+{
+    uint128_t r;
+    if (binom_u128(n, k, r)) {
+        return big_uint(r);
+    }
+    k = std::min(k, n - k);
+    double w = (std::lgamma(n + 1.0) - std::lgamma(k + 1.0)
+                - std::lgamma(n - k + 1.0)) / std::log(2.0) / 32;
+    if (k * w > 3.0 * n + w * w / 3) {
+        return binom_exact_sieve(n, k);
+    }
+    return binom_exact_mul(n, k);
+}
+
+// Runs f() returning a checksum and prints its time and queries per second
+template <typename F>
+void bench(const char* name, size_t queries, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t chk = f();
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cout << name << ": " << sec.count() << " sec, "
+              << queries / sec.count() / 1e6 << " M queries/sec"
+              << ", checksum " << chk << std::endl;
+}
+
+// Benchmarks random queries 0 <= k <= n <= maxn
+int binom_bench(size_t queries, int maxn)
+{
+    std::vector<int> qn(queries), qk(queries);
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < queries; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        qn[i] = (int)(x % (maxn + 1));
+        qk[i] = (int)((x >> 32) % (qn[i] + 1));
+    }
+    std::cout << "queries = " << queries << "; maxn = " << maxn << std::endl;
+
+    auto run = [&](const char* name, int (*f)(int, int)) {
+        bench(name, queries, [&]() {
+            uint64_t chk = 0;
+            for (size_t i = 0; i < queries; i++) {
+                chk += (uint32_t)f(qn[i], qk[i]);
+            }
+            return chk;
+        });
+    };
+    run("binomialCoeff1", binomialCoeff1);
+    run("binomialCoeff2", binomialCoeff2);
+    run("binomialCoeff3", binomialCoeff3);
+
+    binom_table tbl;
+    bench("binom_table   ", queries, [&]() {
+        uint64_t chk = 0;
+        for (size_t i = 0; i < queries; i++) {
+            chk += (uint32_t)tbl(qn[i], qk[i]);
+        }
+        return chk;
+    });
+    if (maxn < BINOM_CT_ROWS) {
+        bench("binom_ct      ", queries, [&]() {
+            uint64_t chk = 0;
+            for (size_t i = 0; i < queries; i++) {
+                chk += (uint32_t)binom_ct(qn[i], qk[i]);
+            }
+            return chk;
+        });
+    }
+    bench("binom_u128    ", queries, [&]() {
+        uint64_t chk = 0;
+        for (size_t i = 0; i < queries; i++) {
+            uint128_t r;
+            binom_u128(qn[i], qk[i], r);
+            chk += (uint32_t)r;
+        }
+        return chk;
+    });
+
+    // big results: the time grows with the size of the result
+    for (uint64_t n : { 1000, 10000, 100000, 1000000 }) {
+        auto t0 = std::chrono::steady_clock::now();
+        big_uint b = binom_exact(n, n / 2);
+        std::chrono::duration<double> sec =
+            std::chrono::steady_clock::now() - t0;
+        std::cout << "binom_exact(" << n << ", " << n / 2 << "): "
+                  << sec.count() << " sec, " << b.bits() << " bits"
+                  << std::endl;
+    }
+    return 0;
+}
+
+// Benchmarks binom_mod: random queries n <= 10^6 in the tables of
+// the common moduli, binomialCoeff2 for comparison (on n <= 1000,
+// it is O(n*k) per query) and Lucas with a small p for n up to 10^18
+int binom_mod_bench(size_t queries)
+{
+    uint64_t x = 88172645463325252ULL;
+    auto rnd = [&]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+    auto gen = [&](uint64_t maxn, std::vector<uint64_t>& qn,
+                   std::vector<uint64_t>& qk) {
+        qn.resize(queries);
+        qk.resize(queries);
+        for (size_t i = 0; i < queries; i++) {
+            qn[i] = rnd() % (maxn + 1);
+            qk[i] = rnd() % (qn[i] + 1);
+        }
+    };
+    std::vector<uint64_t> qn, qk;
+    std::vector<uint32_t> out(queries);
+    std::cout << "queries = " << queries << std::endl;
+
+    const size_t small = std::min<size_t>(queries, 100000);
+    gen(1000, qn, qk);
+    bench("binomialCoeff2, n <= 1000   ", small, [&]() {
+        uint64_t chk = 0;
+        for (size_t i = 0; i < small; i++) {
+            chk += (uint32_t)binomialCoeff2(qn[i], qk[i]);
+        }
+        return chk;
+    });
+
+    gen(1000000, qn, qk);
+    for (uint32_t p : { 1000000007u, 998244353u }) {
+        std::cout << "p = " << p << std::endl;
+        auto t0 = std::chrono::steady_clock::now();
+        binom_mod bm(p, 1000000);
+        std::chrono::duration<double> sec =
+            std::chrono::steady_clock::now() - t0;
+        std::cout << "binom_mod tables up to 10^6: " << sec.count() << " sec"
+                  << std::endl;
+        bench("binom_mod, n <= 10^6        ", queries, [&]() {
+            uint64_t chk = 0;
+            for (size_t i = 0; i < queries; i++) {
+                chk += bm(qn[i], qk[i]);
+            }
+            return chk;
+        });
+        bench("binom_mod::batch, n <= 10^6 ", queries, [&]() {
+            bm.batch(qn.data(), qk.data(), out.data(), queries);
+            uint64_t chk = 0;
+            for (auto c : out) {
+                chk += c;
+            }
+            return chk;
+        });
+    }
+
+    gen(1000000000000000000ULL, qn, qk);
+    binom_mod lucas(1009, 1008);
+    std::cout << "p = " << lucas.p() << std::endl;
+    bench("binom_mod (Lucas), n <= 10^18", queries, [&]() {
+        lucas.batch(qn.data(), qk.data(), out.data(), queries);
+        uint64_t chk = 0;
+        for (auto c : out) {
+            chk += c;
+        }
+        return chk;
+    });
+    return 0;
+}
+
+// Checks the compile-time tables against the runtime functions,
+// returns the number of mismatches
+int binom_const_check()
+{
+    int errors = 0;
+    binom_table tbl;
+    for (int n = 0; n < BINOM_CT_ROWS; n++) {
+        for (int k = 0; k <= n; k++) {
+            uint128_t r;
+            binom_u128(n, k, r);
+            errors += (binom_ct(n, k) != tbl(n, k)) + (binom_ct(n, k) != r);
+            // the int versions are exact while C(n, k) fits int
+            if (n <= 30) {
+                errors += (binom_ct(n, k) != (uint64_t)binomialCoeff1(n, k));
+                errors += (binom_ct(n, k) != (uint64_t)binomialCoeff2(n, k));
+            }
+        }
+    }
+
+    // Gosper's hack over the 5-subsets of 20: ranks 0, 1, 2, ...
+    const int N = 20, K = 5;
+    uint64_t rank = 0;
+    for (uint64_t s = (1 << K) - 1; !(s & (1 << N)); rank++) {
+        errors += (subset_rank_ct<N, K>(s) != rank);
+        uint64_t lo = s & ~(s - 1);
+        uint64_t lz = (s + lo) & ~s;
+        s |= lz;
+        s &= ~(lz - 1);
+        s |= (lz >> __builtin_ffsll(lo)) - 1;
+    }
+    errors += (rank != tbl(N, K));
+
+    std::cout << "binom_const: " << BINOM_CT_ROWS << " rows, "
+              << "rank_table<" << N << ", " << K << ">: "
+              << errors << " errors" << std::endl;
+    return errors;
+}
+
+// Largest n of the quadratic tables in the interactive mode
+const int BINOM_TABLE_MAXN = 1 << 12;
+
 int main(int argc, char* argv[])
 {
+    // benchmark mode: binom_n_k bench [queries [maxn]]
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        size_t queries = (argc > 2) ? atoll(argv[2]) : 1000000;
+        int maxn = (argc > 3) ? atoi(argv[3]) : 30;
+        return binom_bench(queries, maxn);
+    }
+    // binom_n_k check: the compile-time tables vs the runtime functions
+    if (argc > 1 && std::string(argv[1]) == "check") {
+        return binom_const_check() ? 1 : 0;
+    }
+    // binom_n_k bench_mod [queries]
+    if (argc > 1 && std::string(argv[1]) == "bench_mod") {
+        return binom_mod_bench((argc > 2) ? atoll(argv[2]) : 10000000);
+    }
+
     int n = 1, k = 1;
     std::cout << "Enter n and k:" << std::endl;
     std::cin >> n >> k;
     std::cout << "n = " << n << "; k = " << k << std::endl;
 
-    std::cout << "binomialCoeff1(n, k) = " << binomialCoeff1(n, k) << std::endl;
+    // the table and binomialCoeff1 take O(n^2) and O(nk) memory,
+    // they are skipped beyond BINOM_TABLE_MAXN
+    if (n <= BINOM_TABLE_MAXN && k <= BINOM_TABLE_MAXN) {
+        std::cout << "binomialCoeff1(n, k) = " << binomialCoeff1(n, k)
+                  << std::endl;
+    }
     std::cout << "binomialCoeff2(n, k) = " << binomialCoeff2(n, k) << std::endl;
     std::cout << "binomialCoeff3(n, k) = " << binomialCoeff3(n, k) << std::endl;
+    if (n <= BINOM_TABLE_MAXN) {
+        binom_table tbl;
+        std::cout << "binom_table(n, k)    = " << tbl(n, k) << std::endl;
+    }
+    if (n >= 0 && k >= 0) {
+        std::cout << "binom_exact(n, k)    = " << binom_exact(n, k).str()
+                  << std::endl;
+        // larger n by Lucas' theorem or multiplicatively
+        binom_mod bm(1000000007, std::min(n, BINOM_TABLE_MAXN));
+        std::cout << "binom_mod(n, k)      = " << bm(n, k)
+                  << " (mod " << bm.p() << ")" << std::endl;
+    }
 
     return 0;
 }
@@ -1,6 +1,17 @@
 #include <stdint.h>
 #include <iostream>
-#include <fstream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <stdlib.h>  // atoll()
+#include <thread>
+#include <sys/uio.h> // writev()
+#include <limits.h>  // IOV_MAX
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "../common/int_reader.h"
 
 // Every move rearranges one 1-bit and one 0-bit in the number so that
 // the number gets decreased, but still the number of bits set is the same,
@@ -26,6 +37,11 @@ uint32_t play_game(uint32_t n)
     uint32_t c1 = 0;        // counter for 1-bits seen so far
     uint32_t rc = 0;        // result counter
 
+    // no 1-bits, no moves (and the skip below would never stop)
+    if (!n) {
+        return 0;
+    }
+
     // skip heading zeros
     while (!(n & x)) {
         x >>= 1;
@@ -48,22 +64,415 @@ uint32_t play_game(uint32_t n)
     return rc;
 }
 
+// Population count, the hardware instruction if the target has one
+inline uint32_t popcount64(uint64_t x)
+{
+#if defined(__POPCNT__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (x * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+// Same count for 64-bit numbers in O(1), without branches.
+// Looking from the other side, the j-th 1-bit from the right (j from 0)
+// at position p passes p - j 0-bits on its way to the right, so
+// the count is the sum of the positions of the 1-bits minus c(c-1)/2,
+// where c is the number of 1-bits. Bit b of the positions sum
+// is collected by one popcount: the 1-bits at positions with bit b set.
+uint32_t play_game64(uint64_t n)
+{
+    static const uint64_t pos_bit[6] = {
+        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+    uint32_t c = popcount64(n);
+    uint32_t sum = 0;
+    for (int b = 0; b < 6; b++) {
+        sum += popcount64(n & pos_bit[b]) << b;
+    }
+    return sum - c * (c - 1) / 2;
+}
+
+// Evaluates play_game for n[0..count) into out, 16 (AVX-512) or 8 (AVX2)
+// numbers at a time, the rest with play_game64.
+// Same formula as play_game64: with AVX-512 VPOPCNTDQ the popcounts of
+// the position masks are single instructions. With AVX2 the bytes are
+// looked up by nibbles: the number of 1-bits and the sum of their
+// positions in the byte, the byte offsets are added by maddubs.
+void play_game_batch(const uint32_t* n, uint32_t* out, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+    const __m512i pos_bit[5] = {
+        _mm512_set1_epi32(0xAAAAAAAA), _mm512_set1_epi32(0xCCCCCCCC),
+        _mm512_set1_epi32(0xF0F0F0F0), _mm512_set1_epi32(0xFF00FF00),
+        _mm512_set1_epi32(0xFFFF0000)
+    };
+    for (; i + 16 <= count; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(n + i));
+        __m512i c = _mm512_popcnt_epi32(v);
+        __m512i sum = _mm512_setzero_si512();
+        for (int b = 0; b < 5; b++) {
+            __m512i pc = _mm512_popcnt_epi32(_mm512_and_si512(v, pos_bit[b]));
+            // maskz forms: gcc 12 warns about the undefined source of slli
+            sum = _mm512_add_epi32(sum, _mm512_maskz_slli_epi32(0xFFFF, pc, b));
+        }
+        // c(c-1) < 2^16, the 16-bit multiplication is enough
+        __m512i c2 = _mm512_mullo_epi16(c, _mm512_sub_epi32(c,
+                                        _mm512_set1_epi32(1)));
+        sum = _mm512_sub_epi32(sum, _mm512_maskz_srli_epi32(0xFFFF, c2, 1));
+        _mm512_storeu_si512((void*)(out + i), sum);
+    }
+#elif defined(__AVX2__)
+    // per nibble: number of 1-bits and sum of their positions
+    const __m256i lut_cnt = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lut_pos = _mm256_setr_epi8(
+        0, 0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 5, 5, 6, 6,
+        0, 0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 5, 5, 6, 6);
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    const __m256i ones8 = _mm256_set1_epi8(1);
+    const __m256i ones16 = _mm256_set1_epi16(1);
+    // position of bit 0 of every byte in its 32-bit number
+    const __m256i offs = _mm256_set1_epi32(0x18100800);
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(n + i));
+        __m256i lo = _mm256_and_si256(v, low4);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low4);
+        __m256i cnt_lo = _mm256_shuffle_epi8(lut_cnt, lo);
+        __m256i cnt_hi = _mm256_shuffle_epi8(lut_cnt, hi);
+        __m256i cnt = _mm256_add_epi8(cnt_lo, cnt_hi);
+        // positions in the byte: the high nibble ones are 4 further
+        __m256i pos = _mm256_add_epi8(
+            _mm256_add_epi8(_mm256_shuffle_epi8(lut_pos, lo),
+                            _mm256_shuffle_epi8(lut_pos, hi)),
+            _mm256_slli_epi16(cnt_hi, 2));
+        __m256i sum16 = _mm256_add_epi16(_mm256_maddubs_epi16(cnt, offs),
+                                         _mm256_maddubs_epi16(pos, ones8));
+        __m256i sum = _mm256_madd_epi16(sum16, ones16);
+        __m256i c = _mm256_madd_epi16(_mm256_maddubs_epi16(cnt, ones8),
+                                      ones16);
+        // c(c-1) < 2^16, the 16-bit multiplication is enough
+        __m256i c2 = _mm256_mullo_epi16(c, _mm256_sub_epi32(c,
+                                        _mm256_set1_epi32(1)));
+        sum = _mm256_sub_epi32(sum, _mm256_srli_epi32(c2, 1));
+        _mm256_storeu_si256((__m256i*)(out + i), sum);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = play_game64(n[i]);
+    }
+}
+
+// Move counts of the long numbers do not fit 64 bits:
+// up to (bits/2)^2 moves
+typedef unsigned __int128 uint128_t;
+
+// Number of moves for a number of any width stored in words[0..count),
+// the least significant word first. Every word adds its own moves
+// (play_game64) plus the moves of its 0-bits past the 1-bits of
+// the more significant words, so it is O(1) per word.
+uint128_t play_game_words(const uint64_t* words, size_t count)
+{
+    uint128_t rc = 0;
+    uint64_t ones = 0;  // 1-bits in the more significant words
+    for (size_t i = count; i-- > 0; ) {
+        uint64_t w = words[i];
+        uint32_t c = popcount64(w);
+        rc += (uint128_t)ones * (64 - c) + play_game64(w);
+        ones += c;
+    }
+    return rc;
+}
+
+// Same as play_game_words, bit by bit like play_game (for the checks)
+uint128_t play_game_words_loop(const uint64_t* words, size_t count)
+{
+    uint128_t rc = 0;
+    uint64_t c1 = 0;
+    for (size_t i = count; i-- > 0; ) {
+        for (uint64_t x = 1ULL << 63; x; x >>= 1) {
+            if (words[i] & x) {
+                c1++;
+            } else {
+                rc += c1;
+            }
+        }
+    }
+    return rc;
+}
+
+std::string to_string(uint128_t v)
+{
+    std::string s;
+    do {
+        s.insert(s.begin(), char('0' + (int)(v % 10)));
+        v /= 10;
+    } while (v);
+    return s;
+}
+
+// Random numbers for the benchmarks (xorshift64*)
+inline uint64_t bench_rand(uint64_t& x)
+{
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    return x * 2685821657736338717ULL;
+}
+
+// Runs f() returning a checksum and prints its time and queries
+// (or other units) per second
+template <typename F>
+void bench(const char* name, size_t queries, F f,
+           const char* unit = "queries")
+{
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t chk = f();
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cout << name << ": " << sec.count() << " sec, "
+              << queries / sec.count() / 1e6 << " M " << unit << "/sec"
+              << ", checksum " << chk << std::endl;
+}
+
+// Benchmarks play_game vs play_game64 on count random numbers
+int game_bench(size_t count)
+{
+    std::vector<uint32_t> ns(count);
+    uint64_t seed = 88172645463325252ULL;
+    for (auto& n : ns) {
+        n = (uint32_t)(bench_rand(seed) >> 32);
+    }
+    std::cout << "queries = " << count << std::endl;
+
+    bench("play_game      ", count, [&]() {
+        uint64_t chk = 0;
+        for (auto n : ns) {
+            chk += play_game(n);
+        }
+        return chk;
+    });
+    // both write the results, so that the batch is compared fairly
+    std::vector<uint32_t> out(count);
+    bench("play_game64    ", count, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = play_game64(ns[i]);
+        }
+        uint64_t chk = 0;
+        for (auto c : out) {
+            chk += c;
+        }
+        return chk;
+    });
+    bench("play_game_batch", count, [&]() {
+        play_game_batch(ns.data(), out.data(), count);
+        uint64_t chk = 0;
+        for (auto c : out) {
+            chk += c;
+        }
+        return chk;
+    });
+
+    size_t errors = 0, batch_errors = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t gcnt = play_game(ns[i]);
+        errors += (gcnt != play_game64(ns[i]));
+        batch_errors += (gcnt != out[i]);
+    }
+    std::cout << "play_game64 errors: " << errors << std::endl;
+    std::cout << "play_game_batch errors: " << batch_errors << std::endl;
+
+    // the same random bits as one number of 32 * count bits
+    std::vector<uint64_t> words(count / 2);
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] = ((uint64_t)ns[2*i + 1] << 32) | ns[2*i];
+    }
+    std::cout << "bits = " << words.size() * 64 << std::endl;
+    uint128_t wcnt = 0, wref = 0;
+    bench("play_game_words     ", words.size() * 64, [&]() {
+        wcnt = play_game_words(words.data(), words.size());
+        return (uint64_t)wcnt;
+    }, "bits");
+    bench("play_game_words_loop", words.size() * 64, [&]() {
+        wref = play_game_words_loop(words.data(), words.size());
+        return (uint64_t)wref;
+    }, "bits");
+    std::cout << "count = " << to_string(wcnt)
+              << ", winner = " << (int)(wcnt & 1) << std::endl;
+    bool words_error = (wcnt != wref);
+    std::cout << "play_game_words errors: " << words_error << std::endl;
+
+    return (errors || batch_errors || words_error) ? 1 : 0;
+}
+
+// Reads the input file: the number of test cases and the numbers,
+// prints the parse rate to stderr
+std::vector<uint32_t> read_input(const char* path)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    int_reader in(path);
+
+    // the header is not trusted: a number takes at least 2 bytes,
+    // so the file size bounds the reservation, a short file the count
+    int tcs = 0;
+    in.next(tcs);
+    tcs = std::max(tcs, 0);
+    std::vector<uint32_t> ns;
+    ns.reserve(std::min<size_t>(tcs, in.bytes() / 2 + 1));
+    uint32_t v;
+    for (int i = 0; i < tcs && in.next(v); i++) {
+        ns.push_back(v);
+    }
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cerr << "parsed " << in.bytes_read() << " bytes, "
+              << in.bytes_read() / sec.count() / 1e6 << " MB/sec" << std::endl;
+    return ns;
+}
+
+// Number of test cases evaluated and written at a time in batch mode
+const size_t BATCH_BLOCK = 1 << 22;
+// Longest output line: "TC4294967295: winner = 1, n = 4294967295, count = 256\n"
+const size_t BATCH_LINE = 64;
+
+// Writes the decimal v at p, returns the end
+inline char* put_uint(char* p, uint64_t v)
+{
+    char tmp[20];
+    int len = 0;
+    do {
+        tmp[len++] = char('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (len) {
+        *p++ = tmp[--len];
+    }
+    return p;
+}
+
+inline char* put_str(char* p, const char* s)
+{
+    while (*s) {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+// Writes all iov to fd with writev, false on errors
+bool write_all(int fd, std::vector<struct iovec> iov)
+{
+    size_t i = 0;
+    while (i < iov.size()) {
+        ssize_t w = writev(fd, &iov[i], (int)std::min<size_t>(iov.size() - i,
+                                                              IOV_MAX));
+        if (w < 0) {
+            return false;
+        }
+        for (; i < iov.size() && (size_t)w >= iov[i].iov_len; i++) {
+            w -= iov[i].iov_len;
+        }
+        if (i < iov.size()) {
+            iov[i].iov_base = (char*)iov[i].iov_base + w;
+            iov[i].iov_len -= w;
+        }
+    }
+    return true;
+}
+
+// Batch mode: the same output as the normal mode for big inputs.
+// The whole input is parsed up front, then every BATCH_BLOCK test cases
+// are split into equal chunks between the threads, each thread
+// evaluates its chunk with play_game_batch and formats its lines into
+// its own buffer, and the buffers go out with one writev.
+int game_batch(const char* path, int threads)
+{
+    std::vector<uint32_t> ns = read_input(path);
+    const size_t tcs = ns.size();
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> tplay(0), twrite(0);
+    std::vector<uint32_t> gcnt(std::min(tcs, BATCH_BLOCK));
+    const size_t chunk = (gcnt.size() + threads - 1) / threads;
+    std::vector< std::vector<char> > bufs(threads,
+                                          std::vector<char>(chunk * BATCH_LINE));
+    std::vector<struct iovec> iov(threads);
+
+    std::string head = "Number of test cases: " + std::to_string(tcs) + "\n";
+    bool ok = write_all(1, { { (void*)head.data(), head.size() } });
+
+    for (size_t b = 0; ok && b < tcs; b += BATCH_BLOCK) {
+        const size_t cnt = std::min(BATCH_BLOCK, tcs - b);
+        auto t1 = std::chrono::steady_clock::now();
+        auto work = [&](int t) {
+            size_t lo = std::min(cnt, t * chunk);
+            size_t hi = std::min(cnt, lo + chunk);
+            play_game_batch(&ns[b + lo], &gcnt[lo], hi - lo);
+            char* p = bufs[t].data();
+            for (size_t i = lo; i < hi; i++) {
+                p = put_str(p, "TC");
+                p = put_uint(p, b + i + 1);
+                p = put_str(p, ": winner = ");
+                *p++ = char('0' + (gcnt[i] & 1));
+                p = put_str(p, ", n = ");
+                p = put_uint(p, ns[b + i]);
+                p = put_str(p, ", count = ");
+                p = put_uint(p, gcnt[i]);
+                *p++ = '\n';
+            }
+            iov[t].iov_base = bufs[t].data();
+            iov[t].iov_len = p - bufs[t].data();
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) {
+            pool.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& th : pool) {
+            th.join();
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        ok = write_all(1, iov);
+        tplay += t2 - t1;
+        twrite += std::chrono::steady_clock::now() - t2;
+    }
+
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cerr << "threads = " << threads << ": "
+              << tcs / sec.count() / 1e6 << " M queries/sec"
+              << " (play and format " << tplay.count() << " sec"
+              << ", write " << twrite.count() << " sec)" << std::endl;
+    return ok ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
     if (argc < 2) {
         std::cout << "Usage:" << std::endl;
         std::cout << argv[0] << " <input_file>" << std::endl;
+        std::cout << argv[0] << " bench [queries]" << std::endl;
+        std::cout << argv[0] << " batch <input_file> [threads]" << std::endl;
         return 1;
     }
-    std::ifstream ifs(argv[1]);
+    if (std::string(argv[1]) == "bench") {
+        return game_bench((argc > 2) ? atoll(argv[2]) : 10000000);
+    }
+    if (std::string(argv[1]) == "batch" && argc > 2) {
+        int threads = (argc > 3) ? atoi(argv[3])
+                                 : std::thread::hardware_concurrency();
+        return game_batch(argv[2], std::max(1, threads));
+    }
 
-    int tcs = 0;
-    ifs >> tcs;
+    std::vector<uint32_t> ns = read_input(argv[1]);
+    int tcs = (int)ns.size();
     std::cout << "Number of test cases: " << tcs << std::endl;
 
     uint32_t n = 0, gcnt = 0;
     for (int i = 0; i < tcs; i++) {
-        ifs >> n;
+        n = ns[i];
         gcnt = play_game(n);
         std::cout << "TC" << (i+1) << ": "
                   << "winner = " << (gcnt & 1)
@@ -71,6 +480,5 @@ int main(int argc, char* argv[])
                   << ", count = " << gcnt << std::endl;
     }
 
-    ifs.close();
     return 0;
 }
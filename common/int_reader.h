@@ -0,0 +1,205 @@
+#ifndef PUZZLES_COMMON_INT_READER_H
+#define PUZZLES_COMMON_INT_READER_H
+
+// Fast reader of whitespace separated integers, header only:
+//
+//     #include "../common/int_reader.h"
+//
+//     int_reader in(argv[1]);   // or int_reader in(0) for stdin
+//     uint32_t n;
+//     while (in.next(n)) { ... }
+//
+// Regular files are mapped with mmap, anything else (pipes, terminals)
+// is read into memory with read(). The numbers are parsed 8 bytes at
+// a time (SWAR): the run of digits in the next 8 bytes is found
+// with a few arithmetic operations instead of a branch per character,
+// and converted with 3 multiplications.
+
+#include <stdint.h>
+#include <string.h>  // memcpy()
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+
+class int_reader
+{
+public:
+    explicit int_reader(const char* path) : int_reader(open(path, O_RDONLY),
+                                                       true) {}
+    explicit int_reader(int fd) : int_reader(fd, false) {}
+
+    ~int_reader()
+    {
+        if (map_) {
+            munmap(map_, size_);
+        }
+    }
+
+    int_reader(const int_reader&) = delete;
+    int_reader& operator=(const int_reader&) = delete;
+
+    bool ok() const { return ok_; }
+    size_t bytes() const { return end_ - begin_; }
+    size_t bytes_read() const { return p_ - begin_; }
+
+    // Reads the next integer into v, returns false at the end of input.
+    // Any byte other than a digit or '-' (for the signed types)
+    // separates the numbers.
+    template <typename T>
+    bool next(T& v)
+    {
+        static_assert(std::is_integral<T>::value, "integral type expected");
+        bool neg = false;
+        for (;;) {
+            if (p_ == end_) {
+                return false;
+            }
+            if (digit(*p_)) {
+                break;
+            }
+            if (std::is_signed<T>::value && *p_ == '-' &&
+                p_ + 1 != end_ && digit(p_[1])) {
+                neg = true;
+                p_++;
+                break;
+            }
+            p_++;
+        }
+        uint64_t u = parse();
+        v = neg ? (T)(0 - u) : (T)u;
+        return true;
+    }
+
+    // Convenience form of next(), returns 0 at the end of input
+    template <typename T>
+    T get()
+    {
+        T v = 0;
+        next(v);
+        return v;
+    }
+
+private:
+    int_reader(int fd, bool own)
+        : ok_(false), map_(nullptr), size_(0),
+          begin_(nullptr), end_(nullptr), p_(nullptr)
+    {
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            size_ = st.st_size;
+            if (size_ > 0) {
+                void* m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m != MAP_FAILED) {
+                    map_ = m;
+                    madvise(m, size_, MADV_SEQUENTIAL);
+                    begin_ = (const char*)m;
+                    ok_ = true;
+                }
+            } else {
+                ok_ = true;
+            }
+        } else {
+            ok_ = true;
+            size_t len = 0;
+            buf_.resize(1 << 16);
+            for (;;) {
+                if (len == buf_.size()) {
+                    buf_.resize(2 * len);
+                }
+                ssize_t r = read(fd, &buf_[len], buf_.size() - len);
+                if (r <= 0) {
+                    ok_ = (r == 0);
+                    break;
+                }
+                len += r;
+            }
+            buf_.resize(len);
+            begin_ = buf_.data();
+            size_ = len;
+        }
+        if (own) {
+            close(fd);
+        }
+        if (!ok_) {
+            size_ = 0;
+        }
+        end_ = begin_ + (ok_ ? size_ : 0);
+        p_ = begin_;
+    }
+
+    static bool digit(char c)
+    {
+        return (unsigned char)(c - '0') < 10;
+    }
+
+    // Number of leading digit bytes of 8 bytes (little endian)
+    static int digits8(uint64_t w)
+    {
+        // a byte is a digit iff its high nibble is 3 and adding 6
+        // does not carry into the high nibble; a carry out of
+        // a non-digit byte may spoil the bytes after it, never before
+        const uint64_t f0 = 0xF0F0F0F0F0F0F0F0ULL;
+        uint64_t d = ((w & f0) | (((w + 0x0606060606060606ULL) & f0) >> 4))
+                     ^ 0x3333333333333333ULL;
+        // the high bit of every non-zero (non-digit) byte
+        const uint64_t lo7 = 0x7F7F7F7F7F7F7F7FULL;
+        uint64_t hb = (((d & lo7) + lo7) | d) & ~lo7;
+        return hb ? __builtin_ctzll(hb) >> 3 : 8;
+    }
+
+    // Value of the first len (1..8) digits of 8 bytes (little endian)
+    static uint64_t value8(uint64_t w, int len)
+    {
+        // the digits go to the top, the zero bytes in front of them
+        // are leading zeros
+        w = (w - 0x3030303030303030ULL) << (8 * (8 - len));
+        w = (w * 10) + (w >> 8);
+        w = (((w & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((w >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))))
+            >> 32;
+        return w;
+    }
+
+    // Parses the digits at p_ (there is at least one)
+    uint64_t parse()
+    {
+        static const uint64_t pow10[9] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+        };
+        uint64_t u = 0;
+        while (end_ - p_ >= 8) {
+            uint64_t w;
+            memcpy(&w, p_, 8);
+            int len = digits8(w);
+            if (len == 0) {
+                return u;
+            }
+            u = u * pow10[len] + value8(w, len);
+            p_ += len;
+            if (len < 8) {
+                return u;
+            }
+        }
+        // the tail of the input, byte by byte
+        while (p_ != end_ && digit(*p_)) {
+            u = u * 10 + (*p_++ - '0');
+        }
+        return u;
+    }
+
+    bool ok_;
+    void* map_;
+    size_t size_;
+    std::vector<char> buf_;
+    const char* begin_;
+    const char* end_;
+    const char* p_;
+};
+
+#endif // PUZZLES_COMMON_INT_READER_H
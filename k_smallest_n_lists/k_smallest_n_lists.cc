@@ -19,17 +19,19 @@
 // = O(N*MlogM + 2N*logM) = O(N*MlogM)
 
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <utility>        // pair
 #include <functional>     // greater
-#include <iterator>       // istream_iterator
+#include <iterator>       // back_inserter
 #include <memory>         // shared_ptr
 #include <algorithm>      // copy_n, sort
+#include <chrono>
 #include <stdint.h>       // uint32_t
 
+#include "../common/int_reader.h"
+
 using value = uint32_t;
 using vvector = std::vector<value>;
 using pair_vec_val = std::pair<const vvector*, value>;
@@ -130,27 +132,49 @@ int main(int argc, char* argv[])
         std::cout << argv[0] << " <input_file>" << std::endl;
         return 1;
     }
-    std::ifstream ifs(argv[1]);
+    auto t0 = std::chrono::steady_clock::now();
+    int_reader in(argv[1]);
 
+    // read all test cases: the counts are not trusted, the lists grow
+    // as the values arrive and an incomplete test case at the end
+    // of the input is dropped
     int tcs = 0;
-    ifs >> tcs;
-    std::cout << "Number of test cases: " << tcs << std::endl;
-    for (int i = 0; i < tcs; i++) {
-
-        // read test case data
+    in.next(tcs);
+    tcs = std::max(tcs, 0);
+    std::vector< std::shared_ptr<problem_data> > pds;
+    bool complete = true;
+    for (int i = 0; complete && i < tcs; i++) {
         auto pd = std::make_shared<problem_data>();
-        ifs >> pd->n;
-        ifs >> pd->k;
+        complete = in.next(pd->n) && in.next(pd->k);
 
         // read and create n lists
-        pd->lists.resize(pd->n);
-        for (uint32_t i = 0; i < pd->n; i++) {
+        for (size_t j = 0; complete && j < pd->n; j++) {
             uint32_t listlen = 0;
-            ifs >> listlen;
-            pd->lists[i].reserve(listlen);
-            std::copy_n(std::istream_iterator<uint32_t>(ifs), listlen,
-                        std::back_inserter(pd->lists[i]));
+            complete = in.next(listlen);
+            pd->lists.emplace_back();
+            auto& list = pd->lists.back();
+            list.reserve(std::min<size_t>(
+                listlen, (in.bytes() - in.bytes_read()) / 2 + 1));
+            value v;
+            while (complete && list.size() < listlen) {
+                complete = in.next(v);
+                if (complete) {
+                    list.push_back(v);
+                }
+            }
         }
+        if (complete) {
+            pds.push_back(pd);
+        }
+    }
+    tcs = (int)pds.size();
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cerr << "parsed " << in.bytes_read() << " bytes, "
+              << in.bytes_read() / sec.count() / 1e6 << " MB/sec" << std::endl;
+
+    std::cout << "Number of test cases: " << tcs << std::endl;
+    for (int i = 0; i < tcs; i++) {
+        auto pd = pds[i];
 
         // solve the test case
         auto cnt = count_k_order_n_lists(pd);
@@ -160,6 +184,5 @@ int main(int argc, char* argv[])
                   << ", cnt = " << cnt << std::endl;
     }
 
-    ifs.close();
     return 0;
 }
@@ -1,8 +1,44 @@
 #include <iostream>  // std::cin, std::cout
 #include <bitset>
+#include <chrono>
+#include <algorithm> // std::max()
+#include <stdlib.h>  // strtol()
+
+#include "k_subset.h"
+
+// Parses a decimal int into v, false if arg is not one
+static bool parse_int(const char* arg, int& v)
+{
+    char* end;
+    long l = strtol(arg, &end, 10);
+    if (end == arg || *end || l < INT32_MIN || l > INT32_MAX) {
+        return false;
+    }
+    v = (int)l;
+    return true;
+}
 
 int main(int argc, char *argv[])
 {
+    // n, k and the threads of the benchmarks: the subsets are uint64_t
+    // masks, so 0 <= k <= n <= 64, and k_subset_par ranks them
+    // in uint64_t, so C(n, k) < UINT64_MAX (always true for n <= 64)
+    int pn = 40, pk = 8;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    if ((argc != 1 && argc != 3 && argc != 4) ||
+        (argc > 1 && !(parse_int(argv[1], pn) && parse_int(argv[2], pk))) ||
+        (argc > 3 && !parse_int(argv[3], threads)) ||
+        pk < 0 || pk > pn || pn > mask_bits(uint64_t()) || threads < 1 ||
+        subset_binom(pn, pk) == UINT64_MAX) {
+        std::cout << "Usage:" << std::endl;
+        std::cout << argv[0] << " [n k [threads]]" << std::endl;
+        std::cout << "    0 <= k <= n <= " << mask_bits(uint64_t())
+                  << ", threads > 0, default: 40 8 "
+                  << std::max(1u, std::thread::hardware_concurrency())
+                  << std::endl;
+        return 1;
+    }
+
     int k = 3;
     int N = 8;
 
@@ -35,5 +71,95 @@ int main(int argc, char *argv[])
         std::cout << std::endl;
     }
 
+    // the same subsets with k_subsets, their ranks and back
+    for (auto s : k_subsets<uint32_t>(N, k)) {
+        uint64_t r = rank(s);
+        std::cout << std::bitset<8>(s) << ": rank = " << r
+                  << ", unrank(" << r << ") = "
+                  << std::bitset<8>(unrank<uint32_t>(r, k)) << std::endl;
+    }
+
+    // wide masks: 3-subsets of 100 elements
+    uint64_t cnt = 0;
+    for (auto s : k_subsets< wide_mask<2> >(100, 3)) {
+        cnt += (rank(s) == cnt);
+    }
+    std::cout << "k_subsets<wide_mask<2>>(100, 3): " << cnt
+              << " ranked in order of C(100, 3) = " << subset_binom(100, 3)
+              << std::endl;
+
+    // C(n, k) serially and in equal slices between the threads
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t chk = 0;
+    for (auto s : k_subsets<uint64_t>(pn, pk)) {
+        chk += s * 0x9E3779B97F4A7C15ULL;
+    }
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cout << "k_subsets(" << pn << ", " << pk << "): "
+              << sec.count() << " sec, checksum " << chk << std::endl;
+
+    std::vector<uint64_t> tcnt(threads * 8), tchk(threads * 8);
+    t0 = std::chrono::steady_clock::now();
+    k_subset_par<uint64_t>(pn, pk, threads, [&](int t, uint64_t s) {
+        // one cache line per thread
+        tcnt[t * 8]++;
+        tchk[t * 8] += s * 0x9E3779B97F4A7C15ULL;
+    });
+    sec = std::chrono::steady_clock::now() - t0;
+    uint64_t pcnt = 0, pchk = 0;
+    for (int t = 0; t < threads; t++) {
+        pcnt += tcnt[t * 8];
+        pchk += tchk[t * 8];
+    }
+    std::cout << "k_subset_par(" << pn << ", " << pk << ", " << threads
+              << " threads): " << sec.count() << " sec, " << pcnt
+              << " subsets, checksum " << pchk << std::endl;
+
+    // subset sums of C(n, k): recomputed for every subset in Gosper's
+    // order vs updated by the swap of the revolving door
+    std::vector<int> w(pn);
+    uint64_t x = 88172645463325252ULL;
+    for (auto& v : w) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        v = (int)(x % 1000) + 1;
+    }
+    const int target = pk * 500;
+
+    t0 = std::chrono::steady_clock::now();
+    uint64_t hits = 0, total = 0;
+    for (auto s : k_subsets<uint64_t>(pn, pk)) {
+        int sum = 0;
+        for (uint64_t m = s; m; m &= m - 1) {
+            sum += w[__builtin_ctzll(m)];
+        }
+        hits += (sum == target);
+        total += sum;
+    }
+    sec = std::chrono::steady_clock::now() - t0;
+    std::cout << "subset sums, Gosper:          " << sec.count() << " sec, "
+              << hits << " hits, total " << total << std::endl;
+
+    t0 = std::chrono::steady_clock::now();
+    hits = 0;
+    total = 0;
+    revolving_door rd(pn, pk);
+    int sum = 0;
+    for (int i = 0; i < pk; i++) {
+        sum += w[rd.elements()[i]];
+    }
+    for (int out = 0, in = 0; ; ) {
+        hits += (sum == target);
+        total += sum;
+        if (!rd.next(out, in)) {
+            break;
+        }
+        sum += w[in] - w[out];
+    }
+    sec = std::chrono::steady_clock::now() - t0;
+    std::cout << "subset sums, revolving door: " << sec.count() << " sec, "
+              << hits << " hits, total " << total << std::endl;
+
     return 0;
 }
@@ -0,0 +1,345 @@
+#ifndef PUZZLES_K_SUBSET_H
+#define PUZZLES_K_SUBSET_H
+
+// k-subsets of {0, ..., n-1} as bit masks, in the order of Gosper's hack
+// (the masks ascending as numbers, i.e. colexicographic order):
+//
+//     for (auto s : k_subsets<uint64_t>(n, k)) { ... }
+//
+// The masks are uint32_t, uint64_t or wide_mask<W> (W 64-bit words).
+// rank()/unrank() map the subsets to their positions in this order and
+// back (combinatorial number system), so the enumeration can be started
+// anywhere, see k_subset_par.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <thread>
+
+// Mask of W * 64 bits, bit i is bit i % 64 of w[i / 64]
+template <size_t W>
+struct wide_mask
+{
+    uint64_t w[W];
+
+    bool operator==(const wide_mask& o) const
+    {
+        for (size_t i = 0; i < W; i++) {
+            if (w[i] != o.w[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const wide_mask& o) const { return !(*this == o); }
+};
+
+// Bit operations the enumerators need, for every mask type
+
+inline int mask_bits(uint32_t) { return 32; }
+inline int mask_bits(uint64_t) { return 64; }
+template <size_t W>
+inline int mask_bits(const wide_mask<W>&) { return 64 * W; }
+
+inline bool mask_test(uint32_t m, int i) { return (m >> i) & 1; }
+inline bool mask_test(uint64_t m, int i) { return (m >> i) & 1; }
+template <size_t W>
+inline bool mask_test(const wide_mask<W>& m, int i)
+{
+    return (m.w[i / 64] >> (i % 64)) & 1;
+}
+
+inline void mask_set(uint32_t& m, int i) { m |= 1u << i; }
+inline void mask_set(uint64_t& m, int i) { m |= 1ULL << i; }
+template <size_t W>
+inline void mask_set(wide_mask<W>& m, int i)
+{
+    m.w[i / 64] |= 1ULL << (i % 64);
+}
+
+// Lowest k bits set
+template <typename M>
+inline M mask_low(int k)
+{
+    M m = M();
+    for (int i = 0; i < k; i++) {
+        mask_set(m, i);
+    }
+    return m;
+}
+
+// Gosper's hack: the next mask with the same number of bits,
+// false if its highest bit would be n or above
+inline bool mask_next(uint64_t& s, int n)
+{
+    if (!s) {
+        return false;
+    }
+    int t = __builtin_ctzll(s);              // lowest one bit
+    uint64_t run = ~(s >> t);
+    int u = run ? t + __builtin_ctzll(run) : 64; // lowest zero bit above it
+    if (u >= n) {
+        return false;
+    }
+    uint64_t r = s + (1ULL << t);            // move the highest one of the run
+    s = r | (((s ^ r) >> 2) >> t);           // put back the rest at the end
+    return true;
+}
+
+inline bool mask_next(uint32_t& s, int n)
+{
+    uint64_t s64 = s;
+    bool ok = mask_next(s64, n);
+    s = (uint32_t)s64;
+    return ok;
+}
+
+// Same for the wide masks, word by word: the run of ones starting at
+// the lowest one bit t and ending below the zero bit u is replaced
+// by bit u and u-t-1 lowest bits
+template <size_t W>
+inline bool mask_next(wide_mask<W>& s, int n)
+{
+    size_t i = 0;
+    while (i < W && !s.w[i]) {
+        i++;
+    }
+    if (i == W) {
+        return false;
+    }
+    int t = 64 * i + __builtin_ctzll(s.w[i]);
+    int u = t;
+    uint64_t run = ~(s.w[i] >> (t % 64));
+    if (run && (t % 64) + __builtin_ctzll(run) < 64) {
+        u += __builtin_ctzll(run);
+    } else {
+        u = 64 * (i + 1);
+        for (i++; i < W && !~s.w[i]; i++) {
+            u += 64;
+        }
+        if (i < W) {
+            u += __builtin_ctzll(~s.w[i]);
+        }
+    }
+    if (u >= n) {
+        return false;
+    }
+    for (size_t j = 0; j < (size_t)u / 64; j++) {
+        s.w[j] = 0;
+    }
+    s.w[u / 64] &= ~((1ULL << (u % 64)) - 1);
+    mask_set(s, u);
+    for (int j = 0; j < u - t - 1; j++) {
+        mask_set(s, j);
+    }
+    return true;
+}
+
+// C(n, k), saturated at UINT64_MAX
+inline uint64_t subset_binom(int n, int k)
+{
+    if (k < 0 || k > n) {
+        return 0;
+    }
+    if (k > n - k) {
+        k = n - k;
+    }
+    unsigned __int128 c = 1;
+    for (int i = 1; i <= k; i++) {
+        c = c * (n - k + i) / i;
+        if (c > UINT64_MAX) {
+            return UINT64_MAX;
+        }
+    }
+    return (uint64_t)c;
+}
+
+// Position of subset s in the order of mask_next:
+// sum of C(c_i, i+1) over its elements c_0 < c_1 < ...
+// The ranks are uint64_t: for a wide mask with C(n, k) >= 2^64 - 1
+// the positions that do not fit are saturated at UINT64_MAX
+template <typename M>
+uint64_t rank(const M& s)
+{
+    uint64_t r = 0;
+    int i = 0;
+    for (int c = 0; c < mask_bits(s); c++) {
+        if (mask_test(s, c)) {
+            uint64_t b = subset_binom(c, ++i);
+            if (b > UINT64_MAX - 1 - r) {
+                return UINT64_MAX;
+            }
+            r += b;
+        }
+    }
+    return r;
+}
+
+// Subset of k elements at position r of the order of mask_next:
+// the greedy inverse of rank, the elements from the highest one down.
+// Any r < UINT64_MAX: the saturated binomials are above it, so only
+// the first 2^64 - 1 subsets of a wide mask are reachable
+template <typename M>
+M unrank(uint64_t r, int k)
+{
+    M s = M();
+    int c = mask_bits(s);
+    for (int i = k; i > 0; i--) {
+        do {
+            c--;
+        } while (subset_binom(c, i) > r);
+        mask_set(s, c);
+        r -= subset_binom(c, i);
+    }
+    return s;
+}
+
+// Revolving door order of the k-subsets of n elements (Knuth, 7.2.1.3,
+// algorithm R): every step removes one element and adds another one,
+// so a visitor can update its state in O(1) instead of recomputing it:
+//
+//     revolving_door rd(n, k);
+//     visit(rd.elements());
+//     for (int out, in; rd.next(out, in); ) { ... }
+//
+// The steps are O(1) amortized.
+class revolving_door
+{
+public:
+    revolving_door(int n, int k) : k_(k), c_(k + 2)
+    {
+        // c_[1..k] are the elements ascending, c_[k+1] = n is a sentinel
+        for (int j = 1; j <= k; j++) {
+            c_[j] = j - 1;
+        }
+        c_[k + 1] = n;
+    }
+
+    // The current subset, ascending, k_ elements
+    const int* elements() const { return &c_[1]; }
+
+    // Moves to the next subset, which is the current one without out
+    // and with in, false after the last one
+    bool next(int& out, int& in)
+    {
+        int j;
+        if (k_ == 0) {
+            return false;
+        }
+        if (k_ & 1) {
+            if (c_[1] + 1 < c_[2]) {
+                out = c_[1]++;
+                in = c_[1];
+                return true;
+            }
+            j = 2;
+        } else {
+            if (c_[1] > 0) {
+                out = c_[1]--;
+                in = c_[1];
+                return true;
+            }
+            j = 2;
+            goto increase;
+        }
+        for (;;) {
+            // decrease c_j, here c_j = c_{j-1} + 1
+            if (j > k_) {
+                return false;
+            }
+            if (c_[j] >= j) {
+                out = c_[j];
+                in = j - 2;
+                c_[j] = c_[j - 1];
+                c_[j - 1] = j - 2;
+                return true;
+            }
+            j++;
+        increase:
+            // increase c_j, here c_{j-1} = j - 2
+            if (j > k_) {
+                return false;
+            }
+            if (c_[j] + 1 < c_[j + 1]) {
+                out = j - 2;
+                in = c_[j] + 1;
+                c_[j - 1] = c_[j];
+                c_[j]++;
+                return true;
+            }
+            j++;
+        }
+    }
+
+private:
+    int k_;
+    std::vector<int> c_;
+};
+
+// Range of the k-subsets of n elements
+template <typename M>
+class k_subsets
+{
+public:
+    class iterator
+    {
+    public:
+        iterator(const M& s, int n, bool end) : s_(s), n_(n), end_(end) {}
+        const M& operator*() const { return s_; }
+        iterator& operator++()
+        {
+            end_ = !mask_next(s_, n_);
+            return *this;
+        }
+        bool operator!=(const iterator& o) const { return end_ != o.end_; }
+
+    private:
+        M s_;
+        int n_;
+        bool end_;
+    };
+
+    k_subsets(int n, int k) : n_(n), k_(k) {}
+
+    iterator begin() const
+    {
+        return iterator(mask_low<M>(k_), n_, k_ > n_);
+    }
+    iterator end() const { return iterator(M(), n_, true); }
+    uint64_t size() const { return subset_binom(n_, k_); }
+
+private:
+    int n_, k_;
+};
+
+// Enumerates the k-subsets of n elements with threads: thread t gets
+// the subsets of ranks [t*total/threads, (t+1)*total/threads),
+// starts from the unranked first one and calls f(t, s) for each.
+// The ranks are uint64_t, so C(n, k) shall be below UINT64_MAX
+template <typename M, typename F>
+void k_subset_par(int n, int k, int threads, F&& f)
+{
+    const uint64_t total = subset_binom(n, k);
+    auto work = [&](int t) {
+        uint64_t lo = (unsigned __int128)total * t / threads;
+        uint64_t hi = (unsigned __int128)total * (t + 1) / threads;
+        if (lo == hi) {
+            return;
+        }
+        M s = unrank<M>(lo, k);
+        for (uint64_t r = lo; r < hi; r++) {
+            f(t, s);
+            mask_next(s, n);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+#endif // PUZZLES_K_SUBSET_H
@@ -2,6 +2,20 @@
 #include <iterator>
 #include <algorithm> // std::min()
 #include <iostream>  // std::cin, std::cout
+#include <string>
+#include <chrono>
+#include <thread>
+#include <math.h>    // sqrt()
+#include <stdlib.h>  // atoi()
+#include <stdint.h>
+#include <string.h>  // memcpy()
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "../common/int_reader.h"
 
 // Spiral-snake traversal of 2d array (n*m).
 //
@@ -65,23 +79,749 @@ void go_snake(int n, int m,
     }
 }
 
+// Flat row-major matrix (or a view of its sub-matrix):
+// element (x, y) is data[x * stride + y], the rows are not separate
+// allocations, so the whole matrix is one contiguous block of memory
+template <typename T>
+struct matrix
+{
+    T* data;
+    int rows;
+    int cols;
+    int stride;
+
+    T& operator()(int x, int y) const
+    {
+        return data[(size_t)x * stride + y];
+    }
+};
+
+// Same as go_snake, but on the flat matrix and with any callable
+// cb(x, y, val), so that the compiler can inline the visitor
+template <typename T, typename F>
+void go_snake(const matrix<T>& mx, F&& cb)
+{
+    struct { int dx; int dy; } dir[] = { {0,1}, {1,0}, {0,-1}, {-1,0} };
+    const int n = mx.rows, m = mx.cols;
+
+    // number of spiral turns
+    int sp = (std::min(n,m) + 1) / 2;
+
+    for (int s = 0; s < sp; s++) {
+        int x = s, y = s;
+        int dirs = 4;
+        int sx = m - s*2 - 1;
+        int sy = n - s*2 - 1;
+
+        // degenerated case (most inner loop)
+        if (sx <= 0 || sy <= 0) {
+            sx = (sx >= sy) ? sx + 1 : 0;
+            sy = (sx >= sy) ? 0 : sy + 1;
+            dirs = 2;
+        }
+
+        for (int d = 0; d < dirs; d++) {
+            for (int k = 0; k < ((d % 2) ? sy : sx); k++) {
+                cb(x, y, mx(x, y));
+                x += dir[d].dx;
+                y += dir[d].dy;
+            }
+        }
+    }
+}
+
+// Random access to the spiral order of n*m matrix.
+//
+// Ring s (s-th spiral turn) is the border of the (n-2s)*(m-2s) sub-matrix,
+// it is preceded by n*m - (n-2s)*(m-2s) = 2s(n+m-2s) positions.
+// A ring consists of (up to) 4 straight segments: top row, right column,
+// bottom row and left column; the most inner ring may degenerate
+// into a single row or column (see go_snake).
+
+struct snake_seg
+{
+    int x, y;    // start
+    int dx, dy;  // direction
+    int len;
+};
+
+// Fills the segments of ring s, returns their number
+inline int snake_segments(int n, int m, int s, snake_seg seg[4])
+{
+    int w = m - 2*s, h = n - 2*s;
+    if (h == 1) {
+        seg[0] = { s, s, 0, 1, w };
+        return 1;
+    }
+    if (w == 1) {
+        seg[0] = { s, s, 1, 0, h };
+        return 1;
+    }
+    seg[0] = { s,       s,       0,  1, w - 1 };
+    seg[1] = { s,       m-s-1,   1,  0, h - 1 };
+    seg[2] = { n-s-1,   m-s-1,   0, -1, w - 1 };
+    seg[3] = { n-s-1,   s,      -1,  0, h - 1 };
+    return 4;
+}
+
+// Number of spiral positions preceding ring s
+inline long long snake_before(int n, int m, long long s)
+{
+    return 2 * s * ((long long)n + m - 2 * s);
+}
+
+// Finds ring s of spiral position k and offset r of k in the ring
+// O(1): s is the root of 2s(n+m-2s) = k, corrected for rounding errors
+inline void snake_ring(int n, int m, long long k, int& s, long long& r)
+{
+    long long nm = (long long)n + m;
+    int sp = (std::min(n, m) + 1) / 2;
+    s = (int)((nm - sqrt((double)(nm * nm - 4 * k))) / 4);
+    s = std::max(0, std::min(s, sp - 1));
+    while (s > 0 && snake_before(n, m, s) > k) {
+        s--;
+    }
+    while (s + 1 < sp && snake_before(n, m, s + 1) <= k) {
+        s++;
+    }
+    r = k - snake_before(n, m, s);
+}
+
+// Maps spiral position k (0 <= k < n*m) to element (x, y)
+// O(1)
+inline void snake_pos(int n, int m, long long k, int& x, int& y)
+{
+    int s;
+    long long r;
+    snake_ring(n, m, k, s, r);
+
+    snake_seg seg[4];
+    int segs = snake_segments(n, m, s, seg);
+    for (int d = 0; d < segs; d++) {
+        if (r < seg[d].len) {
+            x = seg[d].x + seg[d].dx * (int)r;
+            y = seg[d].y + seg[d].dy * (int)r;
+            return;
+        }
+        r -= seg[d].len;
+    }
+}
+
+// Maps element (x, y) to its spiral position k
+// O(1)
+inline long long snake_index(int n, int m, int x, int y)
+{
+    int s = std::min(std::min(x, y), std::min(n-1-x, m-1-y));
+    int w = m - 2*s, h = n - 2*s;
+    long long r;
+
+    if (h == 1) {
+        r = y - s;
+    } else if (w == 1) {
+        r = x - s;
+    } else if (x == s && y < m-s-1) {
+        r = y - s;
+    } else if (y == m-s-1 && x < n-s-1) {
+        r = (w - 1) + (x - s);
+    } else if (x == n-s-1 && y > s) {
+        r = (w - 1) + (h - 1) + (m-s-1 - y);
+    } else {
+        r = 2 * (w - 1) + (h - 1) + (n-s-1 - x);
+    }
+    return snake_before(n, m, s) + r;
+}
+
+// Traverses spiral positions [k0, k1) of the flat matrix,
+// calls cb(k, x, y, val) for every element
+template <typename T, typename F>
+void go_snake_range(const matrix<T>& mx, long long k0, long long k1, F&& cb)
+{
+    const int n = mx.rows, m = mx.cols;
+    if (k0 >= k1) {
+        return;
+    }
+
+    int s;
+    long long r;
+    snake_ring(n, m, k0, s, r);
+
+    for (long long k = k0; k < k1; s++) {
+        snake_seg seg[4];
+        int segs = snake_segments(n, m, s, seg);
+        for (int d = 0; d < segs && k < k1; d++) {
+            if (r >= seg[d].len) {
+                r -= seg[d].len;
+                continue;
+            }
+            int x = seg[d].x + seg[d].dx * (int)r;
+            int y = seg[d].y + seg[d].dy * (int)r;
+            long long kend = std::min(k1, k + seg[d].len - r);
+            for (; k < kend; k++) {
+                cb(k, x, y, mx(x, y));
+                x += seg[d].dx;
+                y += seg[d].dy;
+            }
+            r = 0;
+        }
+    }
+}
+
+// Number of spiral positions per thread in go_snake_par
+inline long long snake_chunk(int n, int m, int threads)
+{
+    return ((long long)n * m + threads - 1) / std::max(1, threads);
+}
+
+// Parallel spiral traversal of the flat matrix: thread t gets
+// the contiguous range of spiral positions [t*chunk, (t+1)*chunk)
+// (see snake_chunk) and calls cb(k, x, y, val) for its elements,
+// k tells where the element is in the spiral order
+template <typename T, typename F>
+void go_snake_par(const matrix<T>& mx, int threads, F&& cb)
+{
+    long long total = (long long)mx.rows * mx.cols;
+    threads = std::max(1, threads);
+    long long chunk = snake_chunk(mx.rows, mx.cols, threads);
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        long long k0 = std::min(total, chunk * t);
+        long long k1 = std::min(total, chunk * (t + 1));
+        pool.emplace_back([&mx, &cb, k0, k1]() {
+            go_snake_range(mx, k0, k1, cb);
+        });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+// Number of rings whose columns are gathered together by snake_gather
+const int SNAKE_TILE = 16;
+// Number of rows gathered for all tiles of rings before moving on
+const int SNAKE_ROWS = 256;
+
+// Copies the flat matrix into out in the spiral order
+// The top and bottom rows of every ring are contiguous, they are copied
+// directly (the bottom one reversed). The right (left) columns of
+// SNAKE_TILE consecutive rings are adjacent columns of the matrix,
+// so they are gathered together: the tile of columns is transposed
+// by SNAKE_TILE*SNAKE_TILE blocks into SNAKE_TILE sequential outputs,
+// every cache line of the matrix is read only once. All tiles are done
+// for SNAKE_ROWS rows at a time, so that the pages of the rows stay
+// in TLB.
+template <typename T, typename U>
+void snake_gather(const matrix<T>& mx, U* out)
+{
+    const int n = mx.rows, m = mx.cols;
+    const int sp = (std::min(n, m) + 1) / 2;
+
+    // the most inner ring may be a single row or column
+    int full = sp;
+    if (sp > 0 && (n - 2*(sp-1) == 1 || m - 2*(sp-1) == 1)) {
+        full = sp - 1;
+        go_snake_range(mx, snake_before(n, m, full), (long long)n * m,
+                       [&](long long k, int x, int y, const T& val) {
+                           out[k] = val;
+                       });
+    }
+
+    // output of the right column of ring s at row x is rcol[s] + x,
+    // output of the left column is lcol[s] - x
+    std::vector<U*> rcol(full), lcol(full);
+
+    for (int s = 0; s < full; s++) {
+        const int w = m - 2*s, h = n - 2*s;
+        U* o = out + snake_before(n, m, s);
+        rcol[s] = o + (w - 1) - s;
+        lcol[s] = o + 2*(w - 1) + (h - 1) + (n-s-1);
+
+        const T* top = &mx(s, s);
+        std::copy(top, top + w - 1, o);
+        const T* bottom = &mx(n-s-1, s+1);
+        std::reverse_copy(bottom, bottom + w - 1, o + (w - 1) + (h - 1));
+    }
+
+    // right column of ring s: rows [s, n-s-2],
+    // left column of ring s: rows [s+1, n-s-1]
+    auto gather_row = [&](int x, int s0, int s1) {
+        const T* row = &mx(x, 0);
+        for (int s = s0; s < s1; s++) {
+            if (x >= s && x <= n-s-2) {
+                rcol[s][x] = row[m-s-1];
+            }
+            if (x >= s+1 && x <= n-s-1) {
+                lcol[s][-x] = row[s];
+            }
+        }
+    };
+
+    // rows [x, x+SNAKE_TILE) crossing all rings [s0, s1)
+    auto gather_block = [&](int x, int s0, int s1) {
+        U rblk[SNAKE_TILE][SNAKE_TILE];
+        U lblk[SNAKE_TILE][SNAKE_TILE];
+        for (int i = 0; i < SNAKE_TILE; i++) {
+            const T* row = &mx(x + i, 0);
+            std::copy(row + m - s1, row + m - s0, rblk[i]);
+            std::copy(row + s0, row + s1, lblk[i]);
+        }
+        for (int j = 0; j < s1 - s0; j++) {
+            U* r = rcol[s1 - 1 - j] + x;
+            U* l = lcol[s0 + j] - x;
+            for (int i = 0; i < SNAKE_TILE; i++) {
+                r[i] = rblk[i][j];
+                l[-i] = lblk[i][j];
+            }
+        }
+    };
+
+    for (int x0 = 0; x0 < n; x0 += SNAKE_ROWS) {
+        const int x1 = std::min(n, x0 + SNAKE_ROWS);
+        for (int s0 = 0; s0 < full; s0 += SNAKE_TILE) {
+            const int s1 = std::min(full, s0 + SNAKE_TILE);
+
+            // rows of the tile and rows crossing all its rings
+            const int lo = std::max(x0, s0), hi = std::min(x1, n - s0);
+            const int mlo = std::max(lo, s1), mhi = std::min(hi, n - s1);
+
+            int x = lo;
+            for (; x < mlo; x++) {
+                gather_row(x, s0, s1);
+            }
+            for (; x + SNAKE_TILE <= mhi; x += SNAKE_TILE) {
+                gather_block(x, s0, s1);
+            }
+            for (; x < hi; x++) {
+                gather_row(x, s0, s1);
+            }
+        }
+    }
+}
+
+// Spiral position of the element at row-major position j of n*m matrix
+// (the matrix is assumed to fit unsigned, see snake_permute)
+inline long long snake_dst(int n, int m, long long j)
+{
+    unsigned x = (unsigned)j / (unsigned)m;
+    return snake_index(n, m, x, (unsigned)j - x * (unsigned)m);
+}
+
+// Checks if j is the smallest position of its cycle of snake_dst,
+// so that every cycle is moved exactly once without marking
+// the visited positions. Stops at the first smaller position:
+// O(log(n*m)) steps per position on average for the spiral.
+// snake_index is used instead of snake_pos as it needs no sqrt.
+inline bool snake_leader(int n, int m, long long j)
+{
+    for (long long k = snake_dst(n, m, j); k != j; k = snake_dst(n, m, k)) {
+        if (k < j) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rearranges the flat matrix (stride == cols) into the spiral order
+// in place: data[k] becomes the k-th element of the spiral.
+// Same result as snake_gather, but O(1) extra memory instead of
+// the n*m output: every cycle of the permutation is followed
+// from its leader, each element is moved once.
+// The price is the random access and the leader checks,
+// n*m must be less than 2^32.
+template <typename T>
+void snake_permute(const matrix<T>& mx)
+{
+    const int n = mx.rows, m = mx.cols;
+    const long long nm = (long long)n * m;
+    for (long long i = 0; i < nm; i++) {
+        long long k = snake_dst(n, m, i);
+        if (k == i || !snake_leader(n, m, i)) {
+            continue;
+        }
+        T tmp = mx.data[i];
+        for (; k != i; k = snake_dst(n, m, k)) {
+            std::swap(tmp, mx.data[k]);
+        }
+        mx.data[i] = tmp;
+    }
+}
+
+// Inverse of snake_permute: puts the spiral order stored in the flat
+// matrix (stride == cols) back into the row-major order, in place
+template <typename T>
+void snake_unpermute(const matrix<T>& mx)
+{
+    const int n = mx.rows, m = mx.cols;
+    const long long nm = (long long)n * m;
+    for (long long i = 0; i < nm; i++) {
+        long long k = snake_dst(n, m, i);
+        if (k == i || !snake_leader(n, m, i)) {
+            continue;
+        }
+        T tmp = mx.data[i];
+        long long j = i;
+        for (; k != i; j = k, k = snake_dst(n, m, k)) {
+            mx.data[j] = mx.data[k];
+        }
+        mx.data[j] = tmp;
+    }
+}
+
+// Out-of-core traversal of binary files: n*m int32 in row-major order
+
+// Budget of the column buffers of snake_stream (bytes)
+const size_t SNAKE_STREAM_BUF = 64 << 20;
+// Number of rows prefetched ahead of the current one
+const int SNAKE_STREAM_AHEAD = 64;
+
+// Read-only mapping of a matrix file
+struct snake_file
+{
+    const int32_t* data;
+    size_t bytes;
+
+    snake_file(const char* path) : data(nullptr), bytes(0)
+    {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = (const int32_t*)p;
+                bytes = st.st_size;
+                // no readahead around the faults: only the columns
+                // of the current rings are needed, see snake_stream
+                madvise(p, bytes, MADV_RANDOM);
+            }
+        }
+        close(fd);
+    }
+
+    ~snake_file()
+    {
+        if (data) {
+            munmap((void*)data, bytes);
+        }
+    }
+
+    // madvise on the pages covering [p, p+len)
+    void advise(const int32_t* p, size_t len, int advice) const
+    {
+        const uintptr_t page = sysconf(_SC_PAGESIZE);
+        uintptr_t a = (uintptr_t)p & ~(page - 1);
+        uintptr_t b = (uintptr_t)(p + len);
+        madvise((void*)a, b - a, advice);
+    }
+
+    snake_file(const snake_file&) = delete;
+    snake_file& operator=(const snake_file&) = delete;
+};
+
+// Buffered sequential writer of int32
+struct snake_writer
+{
+    int fd;
+    bool ok;
+    std::vector<int32_t> buf;
+    size_t used;
+
+    snake_writer(const char* path) : ok(true), buf(1 << 20), used(0)
+    {
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok = (fd >= 0);
+    }
+
+    ~snake_writer()
+    {
+        flush();
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void put(int32_t v)
+    {
+        if (used == buf.size()) {
+            flush();
+        }
+        buf[used++] = v;
+    }
+
+    void flush()
+    {
+        const char* p = (const char*)buf.data();
+        size_t len = used * sizeof(int32_t);
+        while (ok && len > 0) {
+            ssize_t w = write(fd, p, len);
+            if (w <= 0) {
+                ok = false;
+                break;
+            }
+            p += w;
+            len -= w;
+        }
+        used = 0;
+    }
+
+    snake_writer(const snake_writer&) = delete;
+    snake_writer& operator=(const snake_writer&) = delete;
+};
+
+// Writes the spiral order of n*m matrix file in to file out,
+// returns false on I/O errors.
+// The rings are done in groups of t (as many as fit SNAKE_STREAM_BUF):
+// one pass over the rows of the group copies the t left and t right
+// columns of its rings into buffers, the rest of the rows is not read.
+// Then the rings are emitted one by one: the top and bottom rows
+// straight from the file, the columns from the buffers.
+// The column ranges of the rows ahead and the rows of the next ring
+// are prefetched with MADV_WILLNEED, the passed rows are dropped
+// with MADV_DONTNEED, so RSS is bounded by the buffers and
+// the file is read about once, whatever its size.
+bool snake_stream(const char* in, const char* out, int n, int m)
+{
+    snake_file f(in);
+    if (!f.data || f.bytes != (size_t)n * m * sizeof(int32_t)) {
+        return false;
+    }
+    snake_writer w(out);
+    if (!w.ok) {
+        return false;
+    }
+
+    auto row = [&](int x) { return f.data + (size_t)x * m; };
+    const int sp = (std::min(n, m) + 1) / 2;
+    const int tmax = (int)std::max<size_t>(1, std::min<size_t>(m,
+        SNAKE_STREAM_BUF / (2 * sizeof(int32_t) * n)));
+    std::vector<int32_t> lbuf((size_t)tmax * n), rbuf((size_t)tmax * n);
+
+    for (int s0 = 0; s0 < sp; s0 += tmax) {
+        // rings [s0, s1): left columns [s0, s1), right ones [r0, m-s0)
+        const int s1 = std::min(sp, s0 + tmax), t = s1 - s0, r0 = m - s1;
+        const int x1 = n - s0;
+        auto prefetch = [&](int x) {
+            if (x < x1) {
+                f.advise(row(x) + s0, t, MADV_WILLNEED);
+                f.advise(row(x) + r0, t, MADV_WILLNEED);
+            }
+        };
+        for (int x = s0; x < std::min(x1, s0 + SNAKE_STREAM_AHEAD); x++) {
+            prefetch(x);
+        }
+        for (int x = s0; x < x1; x++) {
+            prefetch(x + SNAKE_STREAM_AHEAD);
+            memcpy(&lbuf[(size_t)(x - s0) * t], row(x) + s0, t * 4);
+            memcpy(&rbuf[(size_t)(x - s0) * t], row(x) + r0, t * 4);
+            if ((x - s0) % SNAKE_STREAM_AHEAD == SNAKE_STREAM_AHEAD - 1) {
+                int xa = x + 1 - SNAKE_STREAM_AHEAD;
+                f.advise(row(xa), (size_t)SNAKE_STREAM_AHEAD * m,
+                         MADV_DONTNEED);
+            }
+        }
+        f.advise(row(s0), (size_t)(x1 - s0) * m, MADV_DONTNEED);
+
+        for (int s = s0; s < s1; s++) {
+            if (s + 1 < sp) {
+                f.advise(row(s + 1), m, MADV_WILLNEED);
+                f.advise(row(n - s - 2), m, MADV_WILLNEED);
+            }
+            snake_seg seg[4];
+            int segs = snake_segments(n, m, s, seg);
+            for (int d = 0; d < segs; d++) {
+                const snake_seg& g = seg[d];
+                if (g.dx == 0) {
+                    const int32_t* p = row(g.x) + g.y;
+                    for (int i = 0; i < g.len; i++) {
+                        w.put(p[g.dy * i]);
+                    }
+                } else {
+                    const int32_t* p = (g.y < s1) ? &lbuf[g.y - s0]
+                                                  : &rbuf[g.y - r0];
+                    for (int i = 0; i < g.len; i++) {
+                        w.put(p[(size_t)(g.x - s0 + g.dx * i) * t]);
+                    }
+                }
+            }
+            f.advise(row(s), m, MADV_DONTNEED);
+            f.advise(row(n - s - 1), m, MADV_DONTNEED);
+        }
+    }
+    w.flush();
+    return w.ok;
+}
+
+// Writes n*m matrix file with the same values as snake_bench uses
+bool snake_gen(const char* out, int n, int m)
+{
+    snake_writer w(out);
+    for (size_t i = 0; w.ok && i < (size_t)n * m; i++) {
+        w.put((int32_t)(i * 2654435761u));
+    }
+    w.flush();
+    return w.ok;
+}
+
 void snake_out(int x, int y, int val)
 {
     // std::cout << x << " " << y << ": "<< val << std::endl;
     std::cout << val << " ";
 }
 
+// checksum of the visited values for the benchmarks
+static long long snake_chk = 0;
+
+void snake_sum(int x, int y, int val)
+{
+    snake_chk += val;
+}
+
+// Runs f() returning a checksum and prints its wall time and throughput
+template <typename F>
+void bench(const char* name, size_t elems, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    long long chk = f();
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cout << name << ": " << sec.count() << " sec, "
+              << elems / sec.count() / 1e6 << " M elements/sec"
+              << ", checksum " << chk << std::endl;
+}
+
+// Benchmarks the traversal of n*m matrices:
+// nested vectors with the function pointer callback vs
+// flat matrix with the function pointer and with the inlined lambda
+int snake_bench(int n, int m)
+{
+    size_t elems = (size_t)n * m;
+    std::cout << "n = " << n << "; m = " << m << std::endl;
+
+    std::vector<int> flat(elems);
+    for (size_t i = 0; i < elems; i++) {
+        flat[i] = (int)(i * 2654435761u);
+    }
+    matrix<const int> mx = { flat.data(), n, m, m };
+
+    {
+        std::vector< std::vector<int> > v2d(n);
+        for (int i = 0; i < n; i++) {
+            v2d[i].assign(flat.begin() + (size_t)i * m,
+                          flat.begin() + (size_t)(i + 1) * m);
+        }
+        bench("go_snake(vector<vector>, snake_cb)", elems, [&]() {
+            snake_chk = 0;
+            go_snake(n, m, v2d, snake_sum);
+            return snake_chk;
+        });
+    }
+
+    bench("go_snake(matrix, snake_cb)       ", elems, [&]() {
+        snake_chk = 0;
+        go_snake(mx, snake_sum);
+        return snake_chk;
+    });
+
+    bench("go_snake(matrix, lambda)         ", elems, [&]() {
+        long long chk = 0;
+        go_snake(mx, [&](int x, int y, int val) { chk += val; });
+        return chk;
+    });
+
+    std::vector<int> out(elems);
+    bench("memcpy                           ", elems, [&]() {
+        std::copy(flat.begin(), flat.end(), out.begin());
+        return (long long)out[elems / 2];
+    });
+    bench("go_snake(matrix, out[k++] = val) ", elems, [&]() {
+        size_t k = 0;
+        go_snake(mx, [&](int x, int y, int val) { out[k++] = val; });
+        return (long long)out[elems / 2];
+    });
+    bench("snake_gather(matrix, out)        ", elems, [&]() {
+        snake_gather(mx, out.data());
+        return (long long)out[elems / 2];
+    });
+
+    // same result without the second n*m buffer
+    std::cout << "snake_permute saves " << elems * sizeof(int) / (1 << 20)
+              << " MB of the snake_gather output" << std::endl;
+    matrix<int> inplace = { out.data(), n, m, m };
+    bench("snake_permute(matrix)            ", elems, [&]() {
+        std::copy(flat.begin(), flat.end(), out.begin());
+        snake_permute(inplace);
+        return (long long)out[elems / 2];
+    });
+    bench("snake_unpermute(matrix)          ", elems, [&]() {
+        snake_unpermute(inplace);
+        return (long long)(out != flat);
+    });
+
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "threads = " << threads << std::endl;
+    bench("go_snake_par(matrix, lambda)     ", elems, [&]() {
+        long long chunk = snake_chunk(n, m, threads);
+        std::vector<long long> chk(threads * 8, 0);
+        go_snake_par(mx, threads, [&](long long k, int x, int y, int val) {
+            // one cache line per thread
+            chk[k / chunk * 8] += val;
+        });
+        long long sum = 0;
+        for (auto c : chk) {
+            sum += c;
+        }
+        return sum;
+    });
+
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
+    // benchmark mode: snake bench [n m]
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int n = (argc > 3) ? atoi(argv[2]) : 10000;
+        int m = (argc > 3) ? atoi(argv[3]) : 10000;
+        return snake_bench(n, m);
+    }
+
+    // binary files of n*m int32: snake gen n m out, snake stream n m in out
+    if (argc > 4 && std::string(argv[1]) == "gen") {
+        return snake_gen(argv[4], atoi(argv[2]), atoi(argv[3])) ? 0 : 1;
+    }
+    if (argc > 5 && std::string(argv[1]) == "stream") {
+        int n = atoi(argv[2]), m = atoi(argv[3]);
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = snake_stream(argv[4], argv[5], n, m);
+        std::chrono::duration<double> sec =
+            std::chrono::steady_clock::now() - t0;
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        std::cout << "snake_stream: " << (ok ? "" : "FAILED, ")
+                  << sec.count() << " sec, "
+                  << (double)n * m * sizeof(int32_t) / sec.count() / 1e6
+                  << " MB/sec, max RSS " << ru.ru_maxrss / 1024 << " MB"
+                  << std::endl;
+        return ok ? 0 : 1;
+    }
+
     size_t n = 0, m = 0;
 
     // read input
-    std::cin >> n >> m;
-    std::vector< std::vector<int> > v2d(n);
+    auto t0 = std::chrono::steady_clock::now();
+    int_reader in(0);
+    in.next(n);
+    in.next(m);
+    std::vector< std::vector<int> > v2d(n, std::vector<int>(m));
     for (size_t i = 0; i < n; i++) {
-        std::copy_n(std::istream_iterator<int>(std::cin), m,
-                    std::back_inserter(v2d[i]));
+        for (size_t j = 0; j < m; j++) {
+            in.next(v2d[i][j]);
+        }
     }
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - t0;
+    std::cerr << "parsed " << in.bytes_read() << " bytes, "
+              << in.bytes_read() / sec.count() / 1e6 << " MB/sec" << std::endl;
 
     // echo input
     std::cout << "n = " << n << "; m = " << m << std::endl;
@@ -95,9 +835,57 @@ int main(int argc, char *argv[])
     go_snake(n, m, v2d, snake_out);
     std::cout << std::endl;
 
+    std::vector<int> flat;
+    for (size_t i = 0; i < n; i++) {
+        flat.insert(flat.end(), v2d[i].begin(), v2d[i].end());
+    }
+    matrix<const int> mx = { flat.data(), (int)n, (int)m, (int)m };
+    std::cout << "go_snake_mx  ";
+    go_snake(mx, [](int x, int y, int val) { std::cout << val << " "; });
+    std::cout << std::endl;
+
     std::cout << "go_snake_rec ";
     go_snake_rec(0, 0, n-1, m-1, v2d, snake_out);
     std::cout << std::endl;
 
+    // 3 threads, so that even small matrices are split
+    std::vector<int> spiral(n * m);
+    go_snake_par(mx, 3, [&](long long k, int x, int y, int val) {
+        spiral[k] = val;
+    });
+    std::cout << "go_snake_par ";
+    std::copy(spiral.begin(), spiral.end(),
+              std::ostream_iterator<int>(std::cout, " "));
+    std::cout << std::endl;
+
+    std::fill(spiral.begin(), spiral.end(), 0);
+    snake_gather(mx, spiral.data());
+    std::cout << "snake_gather ";
+    std::copy(spiral.begin(), spiral.end(),
+              std::ostream_iterator<int>(std::cout, " "));
+    std::cout << std::endl;
+
+    std::vector<int> perm(flat);
+    matrix<int> pmx = { perm.data(), (int)n, (int)m, (int)m };
+    snake_permute(pmx);
+    std::cout << "snake_permute ";
+    std::copy(perm.begin(), perm.end(),
+              std::ostream_iterator<int>(std::cout, " "));
+    std::cout << std::endl;
+    snake_unpermute(pmx);
+    std::cout << "snake_unpermute errors: " << (perm != flat) << std::endl;
+
+    // check the random access mapping against the traversal
+    long long k = 0, errors = 0;
+    go_snake(mx, [&](int x, int y, int val) {
+        int px = -1, py = -1;
+        snake_pos(n, m, k, px, py);
+        if (px != x || py != y || snake_index(n, m, x, y) != k) {
+            errors++;
+        }
+        k++;
+    });
+    std::cout << "snake_pos/snake_index errors: " << errors << std::endl;
+
     return 0;
 }
@@ -2,7 +2,18 @@
 #include <queue>
 #include <algorithm> // std::min()
 #include <iostream>  // std::cin, std::cout
-#include <stdlib.h>  // rand()
+#include <fstream>
+#include <stdlib.h>  // malloc(), free()
+#include <math.h>    // fabs(), ldexp()
+#include <string.h>  // memset()
+#include <thread>
+#include <atomic>
+#include <new>       // std::bad_alloc, std::align_val_t
+#include <malloc.h>  // malloc_usable_size()
+#include <fcntl.h>     // open()
+#include <unistd.h>    // close()
+#include <sys/mman.h>  // mmap(), madvise()
+#include <sys/stat.h>  // fstat()
 
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
@@ -17,6 +28,141 @@ namespace po = boost::program_options;
 #define TDEBUG(x)
 #endif
 
+// Heap allocation statistics collected by the global operator new/delete
+std::atomic<size_t> alloc_count(0);  // number of allocations
+std::atomic<size_t> alloc_bytes(0);  // currently allocated bytes
+std::atomic<size_t> alloc_peak(0);   // peak of allocated bytes
+
+// All replaceable forms of operator new/delete (plain, array, nothrow,
+// sized and aligned) go through these two, so that every block is a plain
+// malloc()/aligned_alloc() block whatever form frees it, and is accounted
+// by its malloc_usable_size() without a header of its own
+void* alloc_counted(size_t size, size_t align = 0)
+{
+    void* p = align > alignof(std::max_align_t)
+        ? aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1)
+                               / align * align)
+        : malloc(std::max<size_t>(size, 1));
+    if (!p) {
+        return nullptr;
+    }
+    alloc_count++;
+    size_t bytes = (alloc_bytes += malloc_usable_size(p));
+    size_t peak = alloc_peak;
+    while (bytes > peak && !alloc_peak.compare_exchange_weak(peak, bytes)) {
+    }
+    return p;
+}
+
+void free_counted(void* p) noexcept
+{
+    if (p) {
+        alloc_bytes -= malloc_usable_size(p);
+        free(p);
+    }
+}
+
+void* operator new(size_t size)
+{
+    void* p = alloc_counted(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return alloc_counted(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return alloc_counted(size);
+}
+
+void operator delete(void* p) noexcept { free_counted(p); }
+void operator delete[](void* p) noexcept { free_counted(p); }
+void operator delete(void* p, size_t) noexcept { free_counted(p); }
+void operator delete[](void* p, size_t) noexcept { free_counted(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free_counted(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free_counted(p);
+}
+
+// the aligned forms are C++17, in a C++11 build the library defaults
+// serve them, which pair aligned_alloc() with free() as well
+#ifdef __cpp_aligned_new
+void* operator new(size_t size, std::align_val_t al)
+{
+    void* p = alloc_counted(size, (size_t)al);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](size_t size, std::align_val_t al)
+{
+    return operator new(size, al);
+}
+void* operator new(size_t size, std::align_val_t al,
+                   const std::nothrow_t&) noexcept
+{
+    return alloc_counted(size, (size_t)al);
+}
+void* operator new[](size_t size, std::align_val_t al,
+                     const std::nothrow_t&) noexcept
+{
+    return alloc_counted(size, (size_t)al);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { free_counted(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free_counted(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    free_counted(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    free_counted(p);
+}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    free_counted(p);
+}
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+    free_counted(p);
+}
+#endif
+
+// Number of allocations and peak of allocated memory
+// from the creation of the object till stop()
+struct alloc_scope
+{
+    size_t count0, bytes0;
+    size_t count, peak;
+
+    alloc_scope()
+        : count0(alloc_count), bytes0(alloc_bytes), count(0), peak(0)
+    {
+        alloc_peak = bytes0;
+    }
+
+    void stop()
+    {
+        count = alloc_count - count0;
+        peak = alloc_peak - bytes0;
+    }
+};
+
 inline uint64_t d2u(const double& d)
 {
     return *((uint64_t*)(&d));
@@ -32,33 +178,134 @@ inline uint16_t get_mnt(const double& d)
     return d2u(d) & 0x1FFFFFFF;
 }
 
-// Generates a random positive double value
-// 0<= value < 1e+200
-// The uppper limit prevents double overflow when summing up an array of values
-double generate_double()
+inline double u2d(const uint64_t& u)
+{
+    return *((double*)(&u));
+}
+
+// Splits [0, n) into (at most) the given number of nearly equal chunks
+// Returns chunk boundaries: chunk i is [bounds[i], bounds[i+1])
+std::vector<size_t> chunk_bounds(size_t n, size_t chunks)
+{
+    chunks = std::max<size_t>(1, std::min(chunks, n));
+    std::vector<size_t> bounds(chunks + 1);
+    for (size_t i = 0; i <= chunks; i++) {
+        bounds[i] = n / chunks * i + std::min(i, n % chunks);
+    }
+    return bounds;
+}
+
+// Runs f(i) for i in [0, count) on count threads and waits for all of them
+template <typename F>
+void parallel_run(size_t count, F f)
+{
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < count; i++) {
+        pool.emplace_back(f, i);
+    }
+    if (count > 0) {
+        f(0);
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+// Distributions of the random input
+enum dist_type
+{
+    DIST_BITS,    // uniformly random bit patterns
+    DIST_UNIT,    // uniform in [0, 1)
+    DIST_LOG,     // log-uniform: exponents uniform in [-64, 64)
+    DIST_CANCEL,  // ill-conditioned: large values cancelled by their negations
+};
+
+// Counter-based PRNG (SplitMix64): the value depends only on the seed
+// and the counter, so every element can be generated independently
+inline uint64_t rng(uint64_t seed, uint64_t ctr)
 {
-    union {
-        double d;
-        uint8_t bytes[sizeof(double)];
-    } u;
-    u.d = -1.0;
+    uint64_t z = seed + (ctr + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Double with the mantissa from the top 52 bits of u,
+// the exponent from its low 7 bits (plus exp_min) and the sign from bit 7
+inline double random_exp_double(uint64_t u, int exp_min, bool with_sign)
+{
+    uint64_t exp = 1023 + exp_min + (u & 0x7F);
+    uint64_t sign = with_sign ? (u & 0x80) << 56 : 0;
+    return u2d(sign | (exp << 52) | (u >> 12));
+}
 
-    while (!(u.d >= 0 && u.d < 1e+200)) {
-        for (auto& b : u.bytes) {
-            b = rand() & 0xFF;
+// Generates element i of the random array of size n
+// DIST_BITS: 0 <= value < 1e+200
+//            or, with_sign = true, -1e+200 < value < 1e+200
+//            The uppper limit prevents double overflow when summing up
+//            an array of values
+// DIST_UNIT: 0 <= value < 1 (or -1 < value < 1)
+// DIST_LOG:  2^-64 <= |value| < 2^64
+// DIST_CANCEL: the first half of the array are values up to 2^128,
+//            the second half are their negations plus a value in [0, 1),
+//            so the exact sum is tiny compared to the sum of magnitudes
+double generate_double(dist_type dist, uint64_t seed, size_t i, size_t n,
+                       bool with_sign)
+{
+    double d = 0.0;
+    switch (dist) {
+    case DIST_BITS:
+        for (uint64_t j = 0; ; j++) {
+            uint64_t u = rng(seed, (i << 6) + j);
+            d = u2d(u);
+            if ((with_sign || !(u >> 63)) && std::fabs(d) < 1e+200) {
+                break;
+            }
+        }
+        break;
+    case DIST_UNIT: {
+        uint64_t u = rng(seed, i);
+        d = (u >> 11) * (1.0 / (1ull << 53));
+        if (with_sign && (u & 1)) {
+            d = -d;
         }
+        break;
+    }
+    case DIST_LOG:
+        d = random_exp_double(rng(seed, i), -64, with_sign);
+        break;
+    case DIST_CANCEL: {
+        size_t half = n / 2;
+        if (i < half) {
+            d = random_exp_double(rng(seed, i), 0, true);
+        } else if (i - half < half) {
+            d = -random_exp_double(rng(seed, i - half), 0, true)
+                + (rng(seed, i) >> 11) * (1.0 / (1ull << 53));
+        } else {
+            d = (rng(seed, i) >> 11) * (1.0 / (1ull << 53));
+        }
+        break;
+    }
     }
-    TDEBUG(("u.d  = %.40e\n") % u.d);
-    return u.d;
+    TDEBUG(("d    = %.40e\n") % d);
+    return d;
 }
 
-// Fills the vector with random double values
-void generate_double_vector(std::vector<double>& v, size_t n)
+// Fills the vector with random double values, in parallel
+// The values depend only on the seed, not on the number of threads
+void generate_double_vector(std::vector<double>& v, size_t n,
+                            dist_type dist, uint64_t seed, bool with_sign)
 {
     TRACE(("\nGenerating random vector...\n"));
     boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
     v.resize(n);
-    std::generate(v.begin(), v.end(), generate_double);
+
+    auto bounds = chunk_bounds(n, std::thread::hardware_concurrency());
+    parallel_run(bounds.size() - 1, [&](size_t c) {
+        for (size_t i = bounds[c]; i < bounds[c + 1]; i++) {
+            v[i] = generate_double(dist, seed, i, n, with_sign);
+        }
+    });
 }
 
 // Sums up all double values of the given array
@@ -148,17 +395,16 @@ double sumH(std::vector<double> v)
     return !v.empty() ? *v.begin() : 0.0;
 }
 
-// Sums up all double values of the given array
+// Sums up all double values of the given sorted array
 // O(N)
 // 2 queues algorithm
-double sumQ(std::vector<double> v)
+double sumQ_sorted(const std::vector<double>& v)
 {
     std::queue<double> q_orig, q_sums;
     if (v.size() == 0) {
         return 0;
     }
 
-    std::sort(v.begin(), v.end());
     for (auto x : v) {
         q_orig.push(x);
     }
@@ -191,13 +437,173 @@ double sumQ(std::vector<double> v)
 }
 
 // Sums up all double values of the given array
-// O(N lonN) for sorting + O(N) for Kahan summation
-double sumK(const std::vector<double>& v)
+// O(N logN) for sorting + O(N) for 2 queues algorithm
+double sumQ(std::vector<double> v)
 {
-    double c = 0, t, y;
-    double sum = 0;
-    for (auto x : v) {
-        y = x - c;
+    std::sort(v.begin(), v.end());
+    return sumQ_sorted(v);
+}
+
+// In-place variants of sum1, sum2, sumH and sumQ:
+// they work on the caller-owned buffer [v, v+n) and destroy its content,
+// but never allocate memory
+
+// See sum1
+double sum1_inplace(double* v, size_t n)
+{
+    if (n == 0) {
+        return 0.0;
+    }
+    for(size_t i = 0; i < n - 1; ++i) {
+        std::sort(v + i, v + n);
+        v[i+1] += v[i];
+    }
+    return v[n - 1];
+}
+
+// See sum2
+double sum2_inplace(double* v, size_t n)
+{
+    if (n == 0) {
+        return 0.0;
+    }
+    for(size_t i = 0; i < n - 1; ++i) {
+        std::partial_sort(v + i, v + i + 2, v + n);
+        v[i+1] += v[i];
+    }
+    return v[n - 1];
+}
+
+// See sumH
+double sumH_inplace(double* v, size_t n)
+{
+    double d1, d2;
+    std::make_heap(v, v + n, std::greater<double>());
+
+    while (n > 1) {
+        d1 = v[0];
+        std::pop_heap(v, v + n--, std::greater<double>());
+
+        d2 = v[0];
+        std::pop_heap(v, v + n--, std::greater<double>());
+
+        v[n++] = d1 + d2;
+        std::push_heap(v, v + n, std::greater<double>());
+    }
+    return n ? v[0] : 0.0;
+}
+
+// 2 queues algorithm over the sorted buffer [v, v+n), allocation free
+// Both queues live in the same array: the original values are read
+// from [i, n), the sums are written to [head, tail) behind them.
+// Every step consumes two values and produces one,
+// so tail never catches up with i.
+double sumQ_merge(double* v, size_t n)
+{
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t i = 0, head = 0, tail = 0;
+
+    auto get_min = [&]() {
+        if (i < n && (head == tail || v[i] < v[head])) {
+            return v[i++];
+        }
+        return (head < tail) ? v[head++] : 0.0;
+    };
+
+    while (i < n || tail - head > 1) {
+        double d = get_min();
+        v[tail++] = d + get_min();
+    }
+
+    return v[head];
+}
+
+// See sumQ
+double sumQ_inplace(double* v, size_t n)
+{
+    std::sort(v, v + n);
+    return sumQ_merge(v, n);
+}
+
+// Maps a double to an unsigned key with the same order:
+// positive values keep their bit pattern with the sign bit set,
+// negative ones get all bits inverted
+inline uint64_t d2key(const double& d)
+{
+    uint64_t u = d2u(d);
+    return u ^ ((u >> 63) ? ~0ull : (1ull << 63));
+}
+
+const int RADIX_BITS = 11;
+const int RADIX_PASSES = (64 + RADIX_BITS - 1) / RADIX_BITS;
+const size_t RADIX_SIZE = (1 << RADIX_BITS);
+
+// LSD radix sort of doubles by their bit patterns (see d2key)
+// O(N): one pass builds the histograms of all digits,
+// then one scatter pass per digit, passes with a single digit value
+// (e.g. the top bits of exponents) are skipped.
+// tmp is a buffer of n values, the sorted values end up in v.
+void radix_sort(double* v, double* tmp, size_t n)
+{
+    std::vector<size_t> hist(RADIX_PASSES * RADIX_SIZE, 0);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k = d2key(v[i]);
+        for (int p = 0; p < RADIX_PASSES; p++) {
+            hist[p * RADIX_SIZE + ((k >> (p * RADIX_BITS)) & (RADIX_SIZE - 1))]++;
+        }
+    }
+
+    double* src = v;
+    double* dst = tmp;
+    for (int p = 0; p < RADIX_PASSES && n > 0; p++) {
+        size_t* h = hist.data() + p * RADIX_SIZE;
+        int shift = p * RADIX_BITS;
+        if (h[(d2key(src[0]) >> shift) & (RADIX_SIZE - 1)] == n) {
+            continue;
+        }
+
+        // bucket offsets
+        size_t off = 0;
+        for (size_t b = 0; b < RADIX_SIZE; b++) {
+            size_t c = h[b];
+            h[b] = off;
+            off += c;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            dst[h[(d2key(src[i]) >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != v) {
+        std::copy(src, src + n, v);
+    }
+}
+
+// Sums up all double values of the given array
+// O(N)
+// 2 queues algorithm, sorted by radix sort
+double sumQr(std::vector<double> v)
+{
+    std::vector<double> tmp(v.size());
+    radix_sort(v.data(), tmp.data(), v.size());
+    return sumQ_merge(v.data(), v.size());
+}
+
+// Kahan summation of the range [first, last)
+// c is the running compensation, it is carried in and out
+// so that the summation can be continued with the next range
+// starting from the returned sum
+double sumK_range(const double* first, const double* last, double& c,
+                  double sum = 0)
+{
+    double t, y;
+    for (; first != last; ++first) {
+        y = *first - c;
         t = sum + y;
         c = (t - sum) - y;
         sum = t;
@@ -205,6 +611,104 @@ double sumK(const std::vector<double>& v)
     return sum;
 }
 
+// Sums up all double values of the given array
+// O(N lonN) for sorting + O(N) for Kahan summation
+double sumK(const std::vector<double>& v)
+{
+    double c = 0;
+    return sumK_range(v.data(), v.data() + v.size(), c);
+}
+
+// Number of independent accumulators in sumP_block
+const size_t SUMP_ACCS = 8;
+
+// Sums up the block [p, p+n) with SUMP_ACCS independent accumulators,
+// so that the additions do not wait for each other
+inline double sumP_block(const double* p, size_t n)
+{
+    double s[SUMP_ACCS] = { 0.0 };
+    size_t i = 0;
+    for (; i + SUMP_ACCS <= n; i += SUMP_ACCS) {
+        for (size_t j = 0; j < SUMP_ACCS; j++) {
+            s[j] += p[i + j];
+        }
+    }
+    for (; i < n; i++) {
+        s[i % SUMP_ACCS] += p[i];
+    }
+    // pairwise, as everything else
+    for (size_t w = SUMP_ACCS / 2; w > 0; w /= 2) {
+        for (size_t j = 0; j < w; j++) {
+            s[j] += s[j + w];
+        }
+    }
+    return s[0];
+}
+
+// Pairwise summation of [p, p+n)
+// Blocks of the given size are summed up directly by sumP_block,
+// the block sums are combined as a binary tree
+double sumP_range(const double* p, size_t n, size_t block)
+{
+    if (n <= block) {
+        return sumP_block(p, n);
+    }
+    size_t m = ((n + block - 1) / block / 2) * block;
+    return sumP_range(p, m, block) + sumP_range(p + m, n - m, block);
+}
+
+// Sums up all double values of the given array
+// O(N)
+// Pairwise (cascade) summation: the error grows as O(log N)
+// instead of O(N) for the naive sum, block is the number of values
+// summed up directly, it should fit L1 cache
+double sumP(const std::vector<double>& v, size_t block)
+{
+    return sumP_range(v.data(), v.size(), std::max<size_t>(block, 1));
+}
+
+// Size of the exponent table used by sumT (one element per double exponent)
+const size_t SUMT_SIZE = 0x7FF;
+
+// Adds d to the exponent table t taking care of the carry:
+// if the sum does not fit the exponent segment any more, it moves up
+// to the segment of its new exponent, and so on
+inline void sumT_add(double* t, double d)
+{
+    uint16_t exp = get_exp(d);
+    double s = t[exp] + d;
+
+    while (get_exp(s) != exp) {
+        t[exp] = 0.0;
+        exp = get_exp(s);
+        s = t[exp] + s;
+    }
+
+    t[exp] = s;
+}
+
+// Adds all values from the exponent table src to the exponent table dst
+inline void sumT_merge(double* dst, const double* src)
+{
+    for (size_t e = 0; e < SUMT_SIZE; e++) {
+        if (src[e] > 0) {
+            sumT_add(dst, src[e]);
+        }
+    }
+}
+
+// Sums up all values from the exponent table
+inline double sumT_total(const double* t)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < SUMT_SIZE; i++) {
+        if (t[i] > 0) {
+            s += t[i];
+        }
+    }
+    return s;
+}
+
 // Sums up all double values of the given array
 // O(N) but not as accurate as O(N logN) solutions
 // The idea is to devide the range of double values into segments.
@@ -212,57 +716,548 @@ double sumK(const std::vector<double>& v)
 // In the end, all preliminary sums are summed up together.
 double sumT(const std::vector<double>& v)
 {
-    double s = 0.0;
-    uint16_t exp = 0;
-
     // table of doubles, one element per double exponent
-    double t[0x7FF];
+    double t[SUMT_SIZE];
     memset(t, 0x00, sizeof(t));
 
     for (auto d : v) {
-        exp = get_exp(d);
-        s = t[exp] + d;
+        sumT_add(t, d);
+    }
 
-        // take care of the carry
-        while (get_exp(s) != exp) {
-            t[exp] = 0.0;
-            exp = get_exp(s);
-            s = t[exp] + s;
+    return sumT_total(t);
+}
+
+// Superaccumulator: a fixed-point number covering the whole double range
+// from 2^-1074 up to 2^1024 with 64 extra bits of headroom for the carry.
+// Every double is added exactly, the sum is rounded only once in the end.
+// The number is stored as signed 64-bit limbs of 32-bit digits,
+// so the carry has to be propagated only once in 2^30 additions.
+struct superacc
+{
+    static const int DIGIT_BITS = 32;
+    static const int LIMBS = (2098 + 64) / DIGIT_BITS + 2;
+    static const uint32_t NORM_PERIOD = (1U << 30);
+
+    int64_t limb[LIMBS];
+    uint32_t cnt;
+
+    superacc() : cnt(0)
+    {
+        memset(limb, 0x00, sizeof(limb));
+    }
+
+    // Adds finite double value d, exactly
+    void add(double d)
+    {
+        uint64_t u = d2u(d);
+        uint64_t mnt = u & 0xFFFFFFFFFFFFFull;
+        int exp = (u >> 52) & 0x7FF;
+
+        // d = mnt * 2^(pos - 1074), pos is the bit position in the accumulator
+        int pos = exp ? exp - 1 : 0;
+        if (exp) {
+            mnt |= (1ull << 52);
+        }
+
+        unsigned __int128 m = (unsigned __int128)mnt << (pos % DIGIT_BITS);
+        int k = pos / DIGIT_BITS;
+        int64_t d0 = (uint32_t)m;
+        int64_t d1 = (uint32_t)(m >> 32);
+        int64_t d2 = (uint32_t)(m >> 64);
+
+        if (u >> 63) {
+            limb[k] -= d0;
+            limb[k + 1] -= d1;
+            limb[k + 2] -= d2;
+        } else {
+            limb[k] += d0;
+            limb[k + 1] += d1;
+            limb[k + 2] += d2;
         }
 
-        t[exp] = s;
+        if (++cnt == NORM_PERIOD) {
+            normalize();
+        }
     }
 
-    // sum up all values from the table
-    s = 0.0;
-    for (auto d : t) {
-        if (d > 0) {
-            s += d;
+    // Subtracts finite double value d, exactly
+    void remove(double d)
+    {
+        add(-d);
+    }
+
+    // Adds all values of the range [first, last)
+    void add(const double* first, const double* last)
+    {
+        for (; first != last; ++first) {
+            add(*first);
         }
     }
-    return s;
+
+    // Adds another accumulator
+    void add(const superacc& other)
+    {
+        normalize();
+        for (int i = 0; i < LIMBS; i++) {
+            limb[i] += other.limb[i];
+        }
+        normalize();
+    }
+
+    // Propagates the carry: all digits but the top one get into [0, 2^32),
+    // the top digit keeps the sign of the number
+    void normalize()
+    {
+        for (int i = 0; i < LIMBS - 1; i++) {
+            int64_t carry = limb[i] >> DIGIT_BITS;
+            limb[i] -= carry * (1ll << DIGIT_BITS);
+            limb[i + 1] += carry;
+        }
+        cnt = 0;
+    }
+
+    // Returns the sum correctly rounded to the nearest double (ties to even)
+    double value() const
+    {
+        superacc a(*this);
+        a.normalize();
+
+        double sign = 1.0;
+        if (a.limb[LIMBS - 1] < 0) {
+            sign = -1.0;
+            for (int i = 0; i < LIMBS; i++) {
+                a.limb[i] = -a.limb[i];
+            }
+            a.normalize();
+        }
+
+        int h = LIMBS - 1;
+        while (h >= 0 && a.limb[h] == 0) {
+            h--;
+        }
+        if (h < 0) {
+            return 0.0;
+        }
+
+        // the top 3 digits hold the 53-bit mantissa plus the rounding bit,
+        // all digits below only matter as the sticky bit
+        int h2 = std::max(h, 2);
+        unsigned __int128 w = ((unsigned __int128)a.limb[h2] << 64) |
+                              ((unsigned __int128)a.limb[h2 - 1] << 32) |
+                              (unsigned __int128)a.limb[h2 - 2];
+        bool sticky = false;
+        for (int i = 0; i < h2 - 2; i++) {
+            sticky = sticky || a.limb[i];
+        }
+
+        int base = (h2 - 2) * DIGIT_BITS;
+        int msb = h * DIGIT_BITS + 31 - __builtin_clz((uint32_t)a.limb[h]);
+        int shift = std::max(msb - 52, 0);
+        int rs = shift - base;
+
+        uint64_t q = (uint64_t)(w >> rs);
+        if (rs > 0) {
+            bool half = (w >> (rs - 1)) & 1;
+            sticky = sticky ||
+                     (w & (((unsigned __int128)1 << (rs - 1)) - 1)) != 0;
+            if (half && (sticky || (q & 1))) {
+                q++;
+            }
+        }
+        return sign * ldexp((double)q, shift - 1074);
+    }
+};
+
+// Sums up all double values of the given array (also negative ones)
+// O(N)
+// Every value is added exactly to the superaccumulator,
+// the result is the correctly rounded exact sum
+double sumE(const std::vector<double>& v)
+{
+    superacc acc;
+    acc.add(v.data(), v.data() + v.size());
+    return acc.value();
+}
+
+// Sums of all windows of w consecutive values of the given array
+// O(N)
+// The window sum is kept in the superaccumulator: the value entering
+// the window is added and the value leaving it is removed, both exactly,
+// so the sums never drift, however many windows there are.
+// Every sum is the correctly rounded sum of its window.
+std::vector<double> sumW(const std::vector<double>& v, size_t w)
+{
+    std::vector<double> sums;
+    if (w == 0 || w > v.size()) {
+        return sums;
+    }
+    sums.reserve(v.size() - w + 1);
+
+    superacc acc;
+    acc.add(v.data(), v.data() + w);
+    sums.push_back(acc.value());
+    for (size_t i = w; i < v.size(); i++) {
+        acc.add(v[i]);
+        acc.remove(v[i - w]);
+        sums.push_back(acc.value());
+    }
+    return sums;
+}
+
+// Read-only memory mapping of a binary file of doubles
+struct mapped_file
+{
+    bool ok;
+    const double* data;
+    size_t size;   // number of doubles
+    size_t bytes;  // size of the mapping
+
+    mapped_file(const std::string& path)
+        : ok(false), data(nullptr), size(0), bytes(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            ok = true;
+            if (st.st_size > 0) {
+                void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE,
+                               fd, 0);
+                if (p != MAP_FAILED) {
+                    data = (const double*)p;
+                    bytes = st.st_size;
+                    size = bytes / sizeof(double);
+                    madvise(p, bytes, MADV_SEQUENTIAL);
+                } else {
+                    ok = false;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~mapped_file()
+    {
+        if (data) {
+            munmap((void*)data, bytes);
+        }
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+};
+
+// Chunk-oriented accumulators: add(first, last) can be called
+// for any number of consecutive chunks, value() returns the sum so far
+
+// Naive sum, see sum0
+struct sum0_acc
+{
+    double s = 0.0;
+
+    void add(const double* first, const double* last)
+    {
+        for (; first != last; ++first) {
+            s += *first;
+        }
+    }
+    double value() const { return s; }
+};
+
+// Kahan summation, see sumK
+struct sumK_acc
+{
+    double s = 0.0;
+    double c = 0.0;
+
+    void add(const double* first, const double* last)
+    {
+        s = sumK_range(first, last, c, s);
+    }
+    double value() const { return s; }
+};
+
+// Exponent table summation, see sumT
+struct sumT_acc
+{
+    double t[SUMT_SIZE];
+
+    sumT_acc()
+    {
+        memset(t, 0x00, sizeof(t));
+    }
+    void add(const double* first, const double* last)
+    {
+        for (; first != last; ++first) {
+            sumT_add(t, *first);
+        }
+    }
+    double value() const { return sumT_total(t); }
+};
+
+// Checks that the values are in the domain of sumT: the sign bit is not
+// set and the exponent is not 0x7FF (inf, NaN), otherwise get_exp() is
+// beyond the exponent table
+struct sumT_domain_acc
+{
+    bool ok = true;
+
+    void add(const double* first, const double* last)
+    {
+        for (; ok && first != last; ++first) {
+            ok = get_exp(*first) < SUMT_SIZE;
+        }
+    }
+    double value() const { return ok; }
+};
+
+// Size of the chunk the mapped file is streamed by, multiple of the page size
+const size_t STREAM_CHUNK = (16 << 20);
+
+// Feeds the mapped file chunk by chunk to the accumulator
+// The next chunk is prefetched and the processed one is dropped,
+// so the resident memory stays flat regardless of the file size
+template <typename Acc>
+double sum_mapped(const mapped_file& f, Acc& acc)
+{
+    const char* base = (const char*)f.data;
+    const size_t bytes = f.size * sizeof(double);
+
+    for (size_t off = 0; off < bytes; off += STREAM_CHUNK) {
+        size_t len = std::min(STREAM_CHUNK, bytes - off);
+        if (off + len < bytes) {
+            madvise((void*)(base + off + len),
+                    std::min(STREAM_CHUNK, bytes - off - len), MADV_WILLNEED);
+        }
+        acc.add((const double*)(base + off), (const double*)(base + off + len));
+        madvise((void*)(base + off), len, MADV_DONTNEED);
+    }
+    return acc.value();
 }
 
-const uint8_t SUM_1 = (1<<0);
-const uint8_t SUM_2 = (1<<1);
-const uint8_t SUM_3 = (1<<2);
-const uint8_t SUM_H = (1<<3);
-const uint8_t SUM_T = (1<<4);
-const uint8_t SUM_Q = (1<<5);
-const uint8_t SUM_K = (1<<6);
-const uint8_t SUM_ALL = 0xFF;
+// Parallel version of sumK
+// Every thread runs Kahan summation on its chunk, the partial sums and their
+// compensations are summed up with Kahan summation again
+double sumK_par(const std::vector<double>& v, size_t threads)
+{
+    auto bounds = chunk_bounds(v.size(), threads);
+    size_t chunks = bounds.size() - 1;
+
+    // partial sum and negated compensation of every chunk
+    std::vector<double> partials(chunks * 2, 0.0);
+    parallel_run(chunks, [&](size_t i) {
+        double c = 0;
+        partials[i * 2] = sumK_range(v.data() + bounds[i],
+                                     v.data() + bounds[i + 1], c);
+        partials[i * 2 + 1] = -c;
+    });
+
+    double c = 0;
+    return sumK_range(partials.data(), partials.data() + partials.size(), c);
+}
+
+// Parallel version of sumT
+// Every thread fills its own exponent table, the tables are merged in the end
+double sumT_par(const std::vector<double>& v, size_t threads)
+{
+    auto bounds = chunk_bounds(v.size(), threads);
+    size_t chunks = bounds.size() - 1;
+
+    std::vector<double> tables(chunks * SUMT_SIZE, 0.0);
+    parallel_run(chunks, [&](size_t i) {
+        double* t = tables.data() + i * SUMT_SIZE;
+        for (size_t j = bounds[i]; j < bounds[i + 1]; j++) {
+            sumT_add(t, v[j]);
+        }
+    });
+
+    for (size_t i = 1; i < chunks; i++) {
+        sumT_merge(tables.data(), tables.data() + i * SUMT_SIZE);
+    }
+    return sumT_total(tables.data());
+}
+
+// Parallel version of sumQ
+// Chunks are sorted in parallel and merged pairwise, also in parallel,
+// the 2 queues algorithm runs on the sorted array, so the result
+// is exactly the same as of sumQ
+double sumQ_par(std::vector<double> v, size_t threads)
+{
+    auto bounds = chunk_bounds(v.size(), threads);
+
+    parallel_run(bounds.size() - 1, [&](size_t i) {
+        std::sort(v.begin() + bounds[i], v.begin() + bounds[i + 1]);
+    });
+
+    while (bounds.size() > 2) {
+        parallel_run((bounds.size() - 1) / 2, [&](size_t i) {
+            std::inplace_merge(v.begin() + bounds[i * 2],
+                               v.begin() + bounds[i * 2 + 1],
+                               v.begin() + bounds[i * 2 + 2]);
+        });
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        if (merged.back() != bounds.back()) {
+            merged.push_back(bounds.back());
+        }
+        bounds.swap(merged);
+    }
+
+    return sumQ_sorted(v);
+}
+
+const uint32_t SUM_1  = (1<<0);
+const uint32_t SUM_2  = (1<<1);
+const uint32_t SUM_3  = (1<<2);
+const uint32_t SUM_H  = (1<<3);
+const uint32_t SUM_T  = (1<<4);
+const uint32_t SUM_Q  = (1<<5);
+const uint32_t SUM_K  = (1<<6);
+const uint32_t SUM_E  = (1<<8);
+const uint32_t SUM_QR = (1<<9);
+const uint32_t SUM_P  = (1<<10);
+const uint32_t SUM_W  = (1<<11);
+const uint32_t SUM_ALL = 0xFFFFFFFF;
+
+// Throughput in MB/s
+double mb_per_sec(size_t bytes, boost::timer::nanosecond_type wall)
+{
+    return bytes / 1e6 / (std::max<boost::timer::nanosecond_type>(1, wall) / 1e9);
+}
+
+// Sums up the binary file of doubles without loading it into a vector
+// Only the algorithms that do not need the whole array are supported:
+// sum0, sumK, sumT (if all values are positive and finite) and sumE
+int sum_input_file(const std::string& path, uint32_t sum)
+{
+    mapped_file f(path);
+    if (!f.ok) {
+        TRACE(("Cannot map %s: %s\n") % path % strerror(errno));
+        return 1;
+    }
+    TRACE(("Input: %s, %d doubles\n") % path % f.size);
+    if (f.bytes % sizeof(double)) {
+        TRACE(("%d trailing bytes ignored\n") % (f.bytes % sizeof(double)));
+    }
+    if (sum & ~(SUM_K | SUM_T | SUM_E)) {
+        TRACE(("sum1, sum2, sum3, sumH, sumQ, sumQr, sumP and sumW "
+               "need the whole array, skipped\n"));
+    }
+    if (sum & SUM_T) {
+        sumT_domain_acc acc;
+        if (!sum_mapped(f, acc)) {
+            TRACE(("sumT supports only positive finite values, skipped\n"));
+            sum &= ~SUM_T;
+        }
+    }
+
+    double s0 = 0.0, sE = 0.0, sK = 0.0, sT = 0.0;
+
+    {
+        TRACE(("\nStreaming sum0...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sum0_acc acc;
+        s0 = sum_mapped(f, acc);
+        TRACE(("sum0 = 0x%016x = % .40e\n"
+               "%.1f MB/s\n")
+              % d2u(s0) % s0
+              % mb_per_sec(f.bytes, t.elapsed().wall));
+    }
+
+    if (sum & SUM_E) {
+        TRACE(("\nStreaming superaccumulator sum...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        superacc acc;
+        sE = sum_mapped(f, acc);
+        TRACE(("sumE = 0x%016x = % .40e\n"
+               "dif0 = 0x%016x = % .40e\n"
+               "%.1f MB/s\n")
+              % d2u(sE) % sE
+              % d2u(sE - s0) % (sE - s0)
+              % mb_per_sec(f.bytes, t.elapsed().wall));
+    }
+
+    if (sum & SUM_K) {
+        TRACE(("\nStreaming sumK...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sumK_acc acc;
+        sK = sum_mapped(f, acc);
+        TRACE(("sumK = 0x%016x = % .40e\n"
+               "dif0 = 0x%016x = % .40e\n"
+               "difE = 0x%016x = % .40e\n"
+               "%.1f MB/s\n")
+              % d2u(sK) % sK
+              % d2u(sK - s0) % (sK - s0)
+              % d2u(sK - sE) % (sK - sE)
+              % mb_per_sec(f.bytes, t.elapsed().wall));
+    }
+
+    if (sum & SUM_T) {
+        TRACE(("\nStreaming sum table...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sumT_acc acc;
+        sT = sum_mapped(f, acc);
+        TRACE(("sumT = 0x%016x = % .40e\n"
+               "dif0 = 0x%016x = % .40e\n"
+               "difE = 0x%016x = % .40e\n"
+               "%.1f MB/s\n")
+              % d2u(sT) % sT
+              % d2u(sT - s0) % (sT - s0)
+              % d2u(sT - sE) % (sT - sE)
+              % mb_per_sec(f.bytes, t.elapsed().wall));
+    }
+
+    return 0;
+}
+
+// Writes the array to the binary file of doubles
+bool save_vector(const std::string& path, const std::vector<double>& v)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write((const char*)v.data(), v.size() * sizeof(double));
+    return ofs.good();
+}
 
 int main(int argc, char *argv[])
 {
     size_t input_size = 10;
+    size_t threads = 1;
+    bool with_sign = false;
+    bool inplace = false;
+    uint64_t seed = time(NULL);
+    size_t block = 2048;
+    size_t window = 1000;
 
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help,h", "Show help")
         ("algo", po::value<std::string>()->default_value("sum3HQT"),
-         "Sum algorithm:\n<sum1 | sum2 | sum3 | sum3HQT | all>")
+         "Sum algorithm:\n<sum1 | sum2 | sum3 | sumH | sumQ | sumK | sumT | sumE |"
+         " sumQr | sumP | sumW | sum3HQT | all>")
         ("size", po::value<size_t>(&input_size)->default_value(input_size),
-         "Size of the array");
+         "Size of the array")
+        ("block", po::value<size_t>(&block)->default_value(block),
+         "Block size of the pairwise sumP")
+        ("window", po::value<size_t>(&window)->default_value(window),
+         "Window size of the sliding sumW")
+        ("threads", po::value<size_t>(&threads)->default_value(threads),
+         "Number of threads for parallel sumQ, sumK and sumT")
+        ("dist", po::value<std::string>()->default_value("bits"),
+         "Distribution of the random array:\n<bits | unit | log | cancel>")
+        ("seed", po::value<uint64_t>(&seed),
+         "Seed of the random array (default: current time)")
+        ("signed", po::bool_switch(&with_sign),
+         "Generate negative values too (sumT is skipped)")
+        ("inplace", po::bool_switch(&inplace),
+         "Also run sum1, sum2, sumH and sumQ in place on a scratch buffer")
+        ("input", po::value<std::string>(),
+         "Sum up the binary file of doubles instead of a random array")
+        ("save", po::value<std::string>(),
+         "Save the random array to the binary file");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -276,7 +1271,7 @@ int main(int argc, char *argv[])
     TRACE(("Algo: %s\n")
           % vm["algo"].as<std::string>());
 
-    uint8_t sum = 0;
+    uint32_t sum = 0;
     if (vm["algo"].as<std::string>() == "sum1") {
         sum = SUM_1;
     } else if (vm["algo"].as<std::string>() == "sum2") {
@@ -291,18 +1286,73 @@ int main(int argc, char *argv[])
         sum = SUM_K;
     } else if (vm["algo"].as<std::string>() == "sumT") {
         sum = SUM_T;
+    } else if (vm["algo"].as<std::string>() == "sumE") {
+        sum = SUM_E;
+    } else if (vm["algo"].as<std::string>() == "sumQr") {
+        sum = SUM_QR;
+    } else if (vm["algo"].as<std::string>() == "sumP") {
+        sum = SUM_P;
+    } else if (vm["algo"].as<std::string>() == "sumW") {
+        sum = SUM_W;
     } else if (vm["algo"].as<std::string>() == "def" ||
                vm["algo"].as<std::string>() == "sum3HQT") {
-        sum = SUM_3 | SUM_H | SUM_Q | SUM_K | SUM_T;
+        sum = SUM_3 | SUM_H | SUM_Q | SUM_QR | SUM_K | SUM_T | SUM_E | SUM_P;
     } else if (vm["algo"].as<std::string>() == "all") {
         sum = SUM_ALL;
     }
 
-    srand(time(NULL));
+    if (vm.count("input")) {
+        return sum_input_file(vm["input"].as<std::string>(), sum);
+    }
+
+    dist_type dist = DIST_BITS;
+    if (vm["dist"].as<std::string>() == "unit") {
+        dist = DIST_UNIT;
+    } else if (vm["dist"].as<std::string>() == "log") {
+        dist = DIST_LOG;
+    } else if (vm["dist"].as<std::string>() == "cancel") {
+        dist = DIST_CANCEL;
+        with_sign = true;
+    }
+
+    TRACE(("Dist: %s, seed: %d\n")
+          % vm["dist"].as<std::string>() % seed);
+
     std::vector<double> input_vector;
-    generate_double_vector(input_vector, input_size);
+    generate_double_vector(input_vector, input_size, dist, seed, with_sign);
+    if (vm.count("save") &&
+        !save_vector(vm["save"].as<std::string>(), input_vector)) {
+        TRACE(("Cannot save %s\n") % vm["save"].as<std::string>());
+        return 1;
+    }
+    if (with_sign && (sum & SUM_T)) {
+        TRACE(("sumT supports only positive values, skipped\n"));
+        sum &= ~SUM_T;
+    }
     double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
     double sT = 0.0, sH = 0.0, sQ = 0.0, sK = 0.0;
+    double sp = 0.0, sE = 0.0, sQr = 0.0, sP = 0.0;
+
+    // caller-owned buffer for the in-place algorithms
+    std::vector<double> scratch(inplace ? input_vector.size() : 0);
+    auto sum_inplace = [&](const char* name, double (*f)(double*, size_t),
+                           double ref) {
+        TRACE(("\nCalculating %s in place...\n") % name);
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
+        std::copy(input_vector.begin(), input_vector.end(), scratch.begin());
+        double si = f(scratch.data(), scratch.size());
+        a.stop();
+        TRACE(("%si = 0x%016x = % .40e\n"
+               "dif  = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
+              % name % d2u(si) % si
+              % d2u(si - ref) % (si - ref)
+              % a.count % (a.peak / 1e6));
+    };
+
+    // wall time of the single threaded sumQ, sumK and sumT
+    boost::timer::nanosecond_type wQ = 0, wK = 0, wT = 0;
 
     double vmax = 0.0, vmin = 1.0;
     for (auto d : input_vector) {
@@ -326,21 +1376,37 @@ int main(int argc, char *argv[])
     if (sum & SUM_1) {
         TRACE(("\nCalculating sum1...\n"));
         boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
         s1 = sum1(input_vector);
+        a.stop();
         TRACE(("sum1 = 0x%016x = % .40e\n"
-               "dif0 = 0x%016x = % .40e\n")
+               "dif0 = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
               % d2u(s1) % s1
-              % d2u(s1 - s0) % (s1 - s0));
+              % d2u(s1 - s0) % (s1 - s0)
+              % a.count % (a.peak / 1e6));
+    }
+
+    if ((sum & SUM_1) && inplace) {
+        sum_inplace("sum1", sum1_inplace, s1);
     }
 
     if (sum & SUM_2) {
         TRACE(("\nCalculating sum2...\n"));
         boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
         s2 = sum2(input_vector);
+        a.stop();
         TRACE(("sum2 = 0x%016x = % .40e\n"
-               "dif0 = 0x%016x = % .40e\n")
+               "dif0 = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
               % d2u(s2) % s2
-              % d2u(s2 - s0) % (s2 - s0));
+              % d2u(s2 - s0) % (s2 - s0)
+              % a.count % (a.peak / 1e6));
+    }
+
+    if ((sum & SUM_2) && inplace) {
+        sum_inplace("sum2", sum2_inplace, s2);
     }
 
     if (sum & SUM_3) {
@@ -356,25 +1422,73 @@ int main(int argc, char *argv[])
     if (sum & SUM_H) {
         TRACE(("\nCalculating sumH...\n"));
         boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
         sH = sumH(input_vector);
+        a.stop();
         TRACE(("sumH = 0x%016x = % .40e\n"
                "dif0 = 0x%016x = % .40e\n"
-               "dif3 = 0x%016x = % .40e\n")
+               "dif3 = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
               % d2u(sH) % sH
               % d2u(sH - s0) % (sH - s0)
-              % d2u(sH - s3) % (sH - s3));
+              % d2u(sH - s3) % (sH - s3)
+              % a.count % (a.peak / 1e6));
+    }
+
+    if ((sum & SUM_H) && inplace) {
+        sum_inplace("sumH", sumH_inplace, sH);
     }
 
     if (sum & SUM_Q) {
         TRACE(("\nCalculating sumQ...\n"));
         boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
         sQ = sumQ(input_vector);
+        a.stop();
         TRACE(("sumQ = 0x%016x = % .40e\n"
                "dif0 = 0x%016x = % .40e\n"
-               "dif3 = 0x%016x = % .40e\n")
+               "dif3 = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
               % d2u(sQ) % sQ
               % d2u(sQ - s0) % (sQ - s0)
-              % d2u(sQ - s3) % (sQ - s3));
+              % d2u(sQ - s3) % (sQ - s3)
+              % a.count % (a.peak / 1e6));
+        wQ = t.elapsed().wall;
+    }
+
+    if ((sum & SUM_Q) && inplace) {
+        sum_inplace("sumQ", sumQ_inplace, sQ);
+    }
+
+    if (sum & SUM_QR) {
+        TRACE(("\nCalculating sumQ with radix sort...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        alloc_scope a;
+        sQr = sumQr(input_vector);
+        a.stop();
+        TRACE(("sumQr = 0x%016x = % .40e\n"
+               "dif0  = 0x%016x = % .40e\n"
+               "dif3  = 0x%016x = % .40e\n"
+               "difQ  = 0x%016x = % .40e\n"
+               "allocs = %d, peak = %.1f MB\n")
+              % d2u(sQr) % sQr
+              % d2u(sQr - s0) % (sQr - s0)
+              % d2u(sQr - s3) % (sQr - s3)
+              % d2u(sQr - sQ) % (sQr - sQ)
+              % a.count % (a.peak / 1e6));
+    }
+
+    if ((sum & SUM_Q) && threads > 1) {
+        TRACE(("\nCalculating sumQ on %d threads...\n") % threads);
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sp = sumQ_par(input_vector, threads);
+        TRACE(("sumQp = 0x%016x = % .40e\n"
+               "difQ  = 0x%016x = % .40e\n"
+               "speedup = %.2f\n")
+              % d2u(sp) % sp
+              % d2u(sp - sQ) % (sp - sQ)
+              % (double(wQ) / std::max<boost::timer::nanosecond_type>(
+                      1, t.elapsed().wall)));
     }
 
     if (sum & SUM_K) {
@@ -387,6 +1501,20 @@ int main(int argc, char *argv[])
               % d2u(sK) % sK
               % d2u(sK - s0) % (sK - s0)
               % d2u(sK - s3) % (sK - s3));
+        wK = t.elapsed().wall;
+    }
+
+    if ((sum & SUM_K) && threads > 1) {
+        TRACE(("\nCalculating sumK on %d threads...\n") % threads);
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sp = sumK_par(input_vector, threads);
+        TRACE(("sumKp = 0x%016x = % .40e\n"
+               "difK  = 0x%016x = % .40e\n"
+               "speedup = %.2f\n")
+              % d2u(sp) % sp
+              % d2u(sp - sK) % (sp - sK)
+              % (double(wK) / std::max<boost::timer::nanosecond_type>(
+                      1, t.elapsed().wall)));
     }
 
     if (sum & SUM_T) {
@@ -399,6 +1527,81 @@ int main(int argc, char *argv[])
               % d2u(sT) % sT
               % d2u(sT - s0) % (sT - s0)
               % d2u(sT - s3) % (sT - s3));
+        wT = t.elapsed().wall;
+    }
+
+    if ((sum & SUM_T) && threads > 1) {
+        TRACE(("\nCalculating sum table on %d threads...\n") % threads);
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sp = sumT_par(input_vector, threads);
+        TRACE(("sumTp = 0x%016x = % .40e\n"
+               "difT  = 0x%016x = % .40e\n"
+               "speedup = %.2f\n")
+              % d2u(sp) % sp
+              % d2u(sp - sT) % (sp - sT)
+              % (double(wT) / std::max<boost::timer::nanosecond_type>(
+                      1, t.elapsed().wall)));
+    }
+
+    if (sum & SUM_E) {
+        TRACE(("\nCalculating superaccumulator sum...\n"));
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sE = sumE(input_vector);
+        TRACE(("sumE = 0x%016x = % .40e\n"
+               "dif0 = 0x%016x = % .40e\n"
+               "dif3 = 0x%016x = % .40e\n")
+              % d2u(sE) % sE
+              % d2u(sE - s0) % (sE - s0)
+              % d2u(sE - s3) % (sE - s3));
+    }
+
+    if (sum & SUM_P) {
+        TRACE(("\nCalculating pairwise sum (block %d)...\n") % block);
+        boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+        sP = sumP(input_vector, block);
+        TRACE(("sumP = 0x%016x = % .40e\n"
+               "dif0 = 0x%016x = % .40e\n"
+               "dif3 = 0x%016x = % .40e\n"
+               "difE = 0x%016x = % .40e\n")
+              % d2u(sP) % sP
+              % d2u(sP - s0) % (sP - s0)
+              % d2u(sP - s3) % (sP - s3)
+              % d2u(sP - sE) % (sP - sE));
+    }
+
+    if ((sum & SUM_W) && window > 0 && window <= input_vector.size()) {
+        std::vector<double> sW;
+        size_t nw = input_vector.size() - window + 1;
+        boost::timer::nanosecond_type wW = 0, wR = 0;
+        {
+            TRACE(("\nCalculating sliding window sums (window %d)...\n")
+                  % window);
+            boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+            sW = sumW(input_vector, window);
+            wW = t.elapsed().wall;
+            TRACE(("windows = %d, %.1f ns per window\n")
+                  % nw % (double(wW) / nw));
+        }
+        {
+            // recomputing all windows is O(N * window), check ~1000 of them
+            size_t step = std::max<size_t>(1, nw / 1000);
+            size_t checked = 0, mismatches = 0;
+            TRACE(("\nRecomputing every %d-th window...\n") % step);
+            boost::timer::auto_cpu_timer t("Done in %t sec CPU, %w sec real\n");
+            for (size_t i = 0; i < nw; i += step, checked++) {
+                superacc acc;
+                acc.add(input_vector.data() + i,
+                        input_vector.data() + i + window);
+                if (acc.value() != sW[i]) {
+                    mismatches++;
+                }
+            }
+            wR = t.elapsed().wall;
+            TRACE(("windows = %d, %.1f ns per window, mismatches = %d\n"
+                   "speedup = %.2f\n")
+                  % checked % (double(wR) / checked) % mismatches
+                  % ((double(wR) / checked) / (double(wW) / nw)));
+        }
     }
 
     return 0;